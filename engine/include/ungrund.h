@@ -20,9 +20,19 @@ typedef struct UGPipeline UGPipeline;
 typedef struct UGUniformBuffer UGUniformBuffer;
 typedef struct UGBindGroupBuilder UGBindGroupBuilder;
 typedef struct UGVertexBuffer UGVertexBuffer;
+typedef struct UGIndexBuffer UGIndexBuffer;
+typedef struct UGIndirectBuffer UGIndirectBuffer;
+typedef struct UGStagingBelt UGStagingBelt;
 typedef struct UGRenderPass UGRenderPass;
+typedef struct UGRenderBundle UGRenderBundle;
+typedef struct UGRenderBundleBuilder UGRenderBundleBuilder;
+typedef struct UGRenderGraph UGRenderGraph;
+typedef struct UGDrawQueue UGDrawQueue;
+typedef struct UGCommandList UGCommandList;
 typedef struct UGTexture UGTexture;
 typedef struct UGSpriteSheet UGSpriteSheet;
+typedef struct UGJobSystem UGJobSystem;
+typedef struct UGJobCounter UGJobCounter;
 
 // Window management
 UGWindow* ug_window_create(const char* title, int width, int height);
@@ -33,6 +43,10 @@ void* ug_window_get_native_handle(UGWindow* window);
 void* ug_window_get_x11_display(void); // Get X11 display (Linux only)
 void* ug_window_get_glfw_handle(UGWindow* window); // Get GLFW handle (internal use)
 void ug_window_get_size(UGWindow* window, int* width, int* height);
+// A window with no OS window behind it: never closes, receives no live events
+// and reports the given size. Pair it with a headless context to drive input
+// callbacks from a replayed input log
+UGWindow* ug_window_create_virtual(int width, int height);
 
 // WebGPU Context management
 // Simple API - creates context with sensible defaults
@@ -43,6 +57,41 @@ UGContextBuilder* ug_context_builder_create(UGWindow* window);
 void ug_context_builder_set_power_preference(UGContextBuilder* builder, WGPUPowerPreference preference);
 void ug_context_builder_set_present_mode(UGContextBuilder* builder, WGPUPresentMode mode);
 void ug_context_builder_set_surface_format(UGContextBuilder* builder, WGPUTextureFormat format);
+// Format of the context's depth buffer (default: WGPUTextureFormat_Depth24Plus)
+void ug_context_builder_set_depth_format(UGContextBuilder* builder, WGPUTextureFormat format);
+// Multisample passes that target the frame: they render into an engine-owned
+// multisampled texture resolved into the frame's view, and the depth buffer,
+// pipelines and bundles follow the count. 1 (default) or 4
+void ug_context_builder_set_sample_count(UGContextBuilder* builder, uint32_t sample_count);
+// Headless mode: no window or surface is needed (pass NULL to ug_context_builder_create).
+// Frames render into an engine-owned offscreen texture of the given size, and a
+// fallback (software) adapter is preferred so it runs on display-less build machines
+void ug_context_builder_set_headless(UGContextBuilder* builder, uint32_t width, uint32_t height);
+// Number of frames ug_run renders before returning (0 = until the window closes).
+// Headless contexts need a frame limit since there is no window to close
+void ug_context_builder_set_frame_limit(UGContextBuilder* builder, uint64_t frame_count);
+// Number of frames the CPU may record ahead of the GPU (1 to UG_MAX_FRAMES_IN_FLIGHT).
+// Each frame in flight gets its own preallocated frame slot that is only recycled
+// once the GPU has finished with it
+#define UG_DEFAULT_FRAMES_IN_FLIGHT 2
+#define UG_MAX_FRAMES_IN_FLIGHT 4
+void ug_context_builder_set_frames_in_flight(UGContextBuilder* builder, uint32_t count);
+// Opt-in GPU profiling of render passes (see GPU profiler below). Needs the
+// adapter's timestamp-query feature; without it the context is created unprofiled
+void ug_context_builder_enable_gpu_profiler(UGContextBuilder* builder, bool enable);
+// Worker threads for the context's job system (see Job system below).
+// UG_JOB_WORKERS_AUTO (default) uses one per hardware thread besides the caller;
+// 0 runs every job inline on the submitting thread
+void ug_context_builder_set_worker_count(UGContextBuilder* builder, uint32_t count);
+// Input record/replay. Recording writes every key, cursor and mouse button event
+// delivered to the window callbacks plus each frame's delta_time to a compact
+// binary log. Replaying ignores live input, delivers the logged events before
+// the frame they were recorded in and substitutes the logged delta_time, so a
+// session reproduces exactly; the run ends with the log. Use a headless context
+// (with a virtual window for the callbacks) to replay at full speed
+// The path is only read during build. Replay wins if both are set
+void ug_context_builder_record_input(UGContextBuilder* builder, const char* path);
+void ug_context_builder_replay_input(UGContextBuilder* builder, const char* path);
 UGContext* ug_context_builder_build(UGContextBuilder* builder);
 void ug_context_builder_destroy(UGContextBuilder* builder);
 
@@ -53,23 +102,205 @@ WGPUQueue ug_context_get_queue(UGContext* context);
 WGPUSurface ug_context_get_surface(UGContext* context);
 WGPUTextureFormat ug_context_get_surface_format(UGContext* context);
 void ug_context_get_surface_size(UGContext* context, uint32_t* width, uint32_t* height);
+bool ug_context_is_headless(UGContext* context);
+WGPUTexture ug_context_get_offscreen_texture(UGContext* context); // NULL unless headless
+uint64_t ug_context_get_frame_limit(UGContext* context);
+uint32_t ug_context_get_frames_in_flight(UGContext* context);
+UGJobSystem* ug_context_get_job_system(UGContext* context);
+// Static 16-bit index buffer for UG_QUAD_INDEX_MAX_QUADS quads laid out as the
+// 4-vertex emitters write them; ug_render_pass_draw_quads binds it for you
+UGIndexBuffer* ug_context_get_quad_index_buffer(UGContext* context);
+// True when the device can take the draw count of a multi-draw from a GPU buffer
+// (wgpu-native's MultiDrawIndirectCount feature, requested when available)
+bool ug_context_supports_multi_draw_indirect_count(UGContext* context);
+// Surface-sized depth buffer shared by depth passes. Created on first use and
+// recreated when the surface size changes (NULL on a zero-sized surface)
+WGPUTextureFormat ug_context_get_depth_format(UGContext* context);
+WGPUTextureView ug_context_get_depth_view(UGContext* context);
+uint32_t ug_context_get_sample_count(UGContext* context);
+// Multisampled color target, kept like the depth buffer (NULL with one sample)
+WGPUTextureView ug_context_get_msaa_view(UGContext* context);
+
+// Frame statistics - rolling window over the last UG_FRAME_STATS_WINDOW frames,
+// collected by ug_begin_render_frame/ug_end_render_frame. Timings that never
+// occur (acquire and present on headless contexts) report zero samples
+#define UG_FRAME_STATS_WINDOW 256
+typedef struct {
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+    uint32_t sample_count;
+} UGTimingStats;
+
+typedef struct {
+    uint32_t draw_calls;
+    uint32_t pipeline_switches;     // Pipelines set on a render pass
+    uint32_t bind_group_switches;   // Bind groups set on a render pass
+    uint64_t upload_bytes;          // Vertex, uniform and texture writes
+    uint32_t redundant_state_calls; // Render pass state calls dropped because nothing changed
+    uint32_t merged_draws;          // Draws folded into the previous contiguous draw
+} UGFrameCounters;
+
+typedef struct {
+    UGTimingStats frame_time;       // Begin of one frame to the begin of the next
+    UGTimingStats cpu_time;         // Recording between begin and end frame (the render callback)
+    UGTimingStats acquire_time;     // Blocked in wgpuSurfaceGetCurrentTexture
+    UGTimingStats submit_time;      // Command buffer finish and queue submit
+    UGTimingStats present_time;     // wgpuSurfacePresent
+    UGFrameCounters last_frame;     // Counters of the most recently ended frame
+    UGFrameCounters peak;           // Per-counter maximum over the window
+    uint64_t frames;                // Frames ended since the context was created
+} UGFrameStats;
+
+bool ug_context_get_frame_stats(UGContext* context, UGFrameStats* out_stats);
+
+// Block until the GPU has finished all work submitted so far
+void ug_context_wait_idle(UGContext* context);
 
 // Context cleanup
 void ug_context_destroy(UGContext* context);
 
 // Render frame management - simplifies render loop boilerplate
+// Frames come from a fixed ring of slots owned by the context; beginning a frame
+// waits until the GPU has finished the previous frame that used the same slot
 UGRenderFrame* ug_begin_render_frame(UGContext* context);
 WGPUTextureView ug_render_frame_get_view(UGRenderFrame* frame);
 WGPUCommandEncoder ug_render_frame_get_encoder(UGRenderFrame* frame);
+uint32_t ug_render_frame_get_index(UGRenderFrame* frame);   // Slot index, 0 to frames_in_flight - 1
+uint64_t ug_render_frame_get_number(UGRenderFrame* frame);  // Monotonic frame number
+// Counter for jobs that must finish before the frame is submitted:
+// ug_end_render_frame waits on it (helping run jobs meanwhile)
+UGJobCounter* ug_render_frame_get_job_counter(UGRenderFrame* frame);
 void ug_end_render_frame(UGRenderFrame* frame);
 
+// Per-frame scratch memory - a linear arena owned by the frame
+// Allocations are valid until ug_end_render_frame, which frees them all at once.
+// The arena grows by chunks as needed and never frees or moves memory mid-frame,
+// so there is no per-allocation free and no stack size limit on transient data
+// align: power of two, or 0 for UG_FRAME_ALLOC_DEFAULT_ALIGN
+// Returns NULL if size is 0 or memory is exhausted
+#define UG_FRAME_ALLOC_DEFAULT_ALIGN 16
+void* ug_frame_alloc(UGRenderFrame* frame, size_t size, size_t align);
+#ifdef __cplusplus
+#define UG_ALIGNOF(type) alignof(type)
+#else
+#define UG_ALIGNOF(type) _Alignof(type)
+#endif
+#define UG_FRAME_ALLOC_ARRAY(frame, type, count) \
+    ((type*)ug_frame_alloc((frame), sizeof(type) * (count), UG_ALIGNOF(type)))
+
+// GPU profiler - per-pass GPU durations from timestamp queries
+// Every render pass is bracketed by timestamps (up to UG_GPU_PROFILER_MAX_PASSES
+// per frame). Results are read back when the frame's slot is reused, so they
+// describe a frame a few frames old and never stall the CPU
+#define UG_GPU_PROFILER_MAX_PASSES 32
+bool ug_profiler_is_enabled(UGContext* context);
+// Copies the duration in milliseconds of each pass of the latest resolved frame,
+// in the order the passes began. Returns the number written (0 before the first result)
+uint32_t ug_profiler_get_pass_times(UGContext* context, double* out_ms, uint32_t max_count);
+// Milliseconds from the first pass's start to the last pass's end
+double ug_profiler_get_frame_gpu_time(UGContext* context);
+// Frame number (see ug_render_frame_get_number) the current results belong to
+uint64_t ug_profiler_get_result_frame(UGContext* context);
+
+// Job system - work-stealing thread pool for CPU work that splits into
+// independent pieces. Each worker has its own deque and idle workers steal;
+// waiting threads run queued jobs instead of blocking
+// Jobs must not touch the render frame (ug_frame_alloc, render passes) or
+// upload GPU data - produce results for the frame's thread to consume
+#define UG_JOB_WORKERS_AUTO UINT32_MAX
+#define UG_JOB_MAX_WORKERS 64
+typedef void (*UGJobFunction)(void* data);
+typedef struct {
+    UGJobFunction function;
+    void* data;
+} UGJobDesc;
+
+UGJobSystem* ug_job_system_create(uint32_t worker_count);  // Owned by the context unless you need your own
+void ug_job_system_destroy(UGJobSystem* system);           // Wait for outstanding jobs first
+uint32_t ug_job_system_get_thread_count(UGJobSystem* system);  // Workers plus the caller
+
+// Counters track completion: each job run with a counter adds one to it and
+// removes one when done. A counter can be reused once it reaches zero
+UGJobCounter* ug_job_counter_create(void);
+void ug_job_counter_destroy(UGJobCounter* counter);
+bool ug_job_counter_is_done(UGJobCounter* counter);
+
+// Queue jobs; counter may be NULL. The job descriptors are copied
+void ug_jobs_run(UGJobSystem* system, const UGJobDesc* jobs, uint32_t count, UGJobCounter* counter);
+// Queue jobs that only start once dependency reaches zero
+void ug_jobs_run_after(UGJobSystem* system, UGJobCounter* dependency, const UGJobDesc* jobs,
+                       uint32_t count, UGJobCounter* counter);
+// Return once counter reaches zero, running queued jobs while waiting
+void ug_jobs_wait(UGJobSystem* system, UGJobCounter* counter);
+
+// Call function over [0, count) split into contiguous [begin, end) batches of at
+// least min_batch_size, spread across the workers and the calling thread.
+// Returns when all batches are done. A NULL system runs everything inline
+typedef void (*UGParallelForFunction)(uint32_t begin, uint32_t end, void* data);
+void ug_parallel_for(UGJobSystem* system, uint32_t count, uint32_t min_batch_size,
+                     UGParallelForFunction function, void* data);
+
 // Application loop - callback-based render loop that handles everything
 // The render_callback is called each frame with the context, delta_time, and userdata
 // delta_time is the time elapsed since the last frame in seconds
-// Returns when the window is closed
+// Returns when the window is closed or the context's frame limit is reached
+// Headless contexts run back-to-back frames at full speed until the frame limit
 typedef void (*UGRenderCallback)(UGContext* context, UGRenderFrame* frame, float delta_time, void* userdata);
 void ug_run(UGContext* context, UGRenderCallback render_callback, void* userdata);
 
+// Fixed-timestep loop - update_callback advances the simulation in constant
+// steps of fixed_dt seconds regardless of the render rate, so results don't
+// depend on frame rate. Each rendered frame then gets alpha in [0, 1): how far
+// real time has moved past the last update, for interpolating between the
+// previous and current simulation state
+// Frame times above max_frame_seconds are clamped (long stalls are dropped, not
+// simulated) and at most max_steps_per_frame updates run per frame; owed time
+// beyond that budget is discarded to keep update cost bounded
+typedef void (*UGUpdateCallback)(UGContext* context, float fixed_dt, void* userdata);
+typedef void (*UGFixedRenderCallback)(UGContext* context, UGRenderFrame* frame, float alpha, void* userdata);
+#define UG_FIXED_STEP_DEFAULT_SECONDS (1.0 / 60.0)
+#define UG_FIXED_STEP_DEFAULT_MAX_FRAME_SECONDS 0.25
+#define UG_FIXED_STEP_DEFAULT_MAX_STEPS 8
+typedef struct {
+    double step_seconds;            // 0 = UG_FIXED_STEP_DEFAULT_SECONDS
+    double max_frame_seconds;       // 0 = UG_FIXED_STEP_DEFAULT_MAX_FRAME_SECONDS
+    uint32_t max_steps_per_frame;   // 0 = UG_FIXED_STEP_DEFAULT_MAX_STEPS
+} UGFixedStepConfig;
+// config may be NULL for the defaults
+void ug_run_fixed(UGContext* context, const UGFixedStepConfig* config,
+                  UGUpdateCallback update_callback, UGFixedRenderCallback render_callback,
+                  void* userdata);
+
+// Threaded loop - pipelines simulation and rendering. The calling (main) thread
+// pumps window events, a simulation thread fills the snapshot for frame N+1
+// while a render thread records and submits frame N from its snapshot
+// Snapshots are snapshot_size bytes, double-buffered and owned by the engine;
+// a snapshot buffer still holds what was written two steps earlier, so
+// simulate should write every field. Window callbacks run on the main thread
+// but never concurrently with simulate, so input state can be shared with it
+// freely. Do GPU uploads in render, not simulate. ug_run stays single-threaded
+typedef void (*UGSimulateCallback)(UGContext* context, float delta_time, void* snapshot, void* userdata);
+typedef void (*UGSnapshotRenderCallback)(UGContext* context, UGRenderFrame* frame,
+                                         const void* snapshot, void* userdata);
+void ug_run_threaded(UGContext* context, size_t snapshot_size, UGSimulateCallback simulate_callback,
+                     UGSnapshotRenderCallback render_callback, void* userdata);
+
+// On-demand loop - for tools and editors that are mostly idle. Sleeps in the
+// window's event wait and only renders after input, a resize/expose, an expired
+// redraw timer or ug_request_redraw, and continuously while animating is set.
+// delta_time covers the whole gap since the previous rendered frame
+// Headless contexts have no events to wait for and render every frame
+void ug_run_on_demand(UGContext* context, UGRenderCallback render_callback, void* userdata);
+// Schedule a redraw for the on-demand loop. Safe to call from any thread
+void ug_request_redraw(UGContext* context);
+// Schedule a redraw once seconds have passed (e.g. a blinking cursor);
+// the earliest pending timer wins. Safe to call from any thread
+void ug_request_redraw_after(UGContext* context, double seconds);
+// While true the on-demand loop renders continuously, like ug_run
+void ug_set_animating(UGContext* context, bool animating);
+
 // Shader utilities
 WGPUShaderModule ug_shader_module_create_from_file(WGPUDevice device, const char* filepath, const char* label);
 WGPUShaderModule ug_shader_module_create_from_source(WGPUDevice device, const char* source, const char* label);
@@ -87,6 +318,27 @@ void ug_renderer_clear(UGRenderer* renderer, float r, float g, float b, float a)
 
 // Utility functions
 double ug_get_time(void);
+uint64_t ug_get_time_ns(void); // Monotonic nanoseconds, usable without a window
+
+// CPU zone profiler - nested timing zones recorded per thread without locks,
+// exported as Chrome/Perfetto trace JSON (chrome://tracing or ui.perfetto.dev)
+// The macros compile to nothing unless UG_ENABLE_PROFILING is defined (make PROFILE=1).
+// Zone names must outlive the trace - pass string literals
+#if defined(UG_ENABLE_PROFILING)
+void ug_profile_zone_begin(const char* name);
+void ug_profile_zone_end(void);
+#define UG_PROFILE_BEGIN(name) ug_profile_zone_begin(name)
+#define UG_PROFILE_END() ug_profile_zone_end()
+#else
+#define UG_PROFILE_BEGIN(name) ((void)0)
+#define UG_PROFILE_END() ((void)0)
+#endif
+// Write the zones recorded so far (the latest ones per thread, older ones are
+// overwritten). Safe while other threads are recording. A thread's zones are
+// released when it exits, so export before joining threads (or destroying the
+// context, which joins the job workers) whose zones you want.
+// Returns false if profiling is compiled out or the write fails
+bool ug_profile_write_chrome_trace(const char* filepath);
 
 // Input handling
 bool ug_key_pressed(UGWindow* window, int key);
@@ -132,6 +384,17 @@ void ug_window_set_mouse_button_callback(UGWindow* window, UGMouseButtonCallback
 UGPipelineBuilder* ug_pipeline_builder_create(UGContext* context, const char* shader_path);
 void ug_pipeline_builder_set_layout(UGPipelineBuilder* builder, WGPUPipelineLayout layout);
 void ug_pipeline_builder_set_vertex_buffer(UGPipelineBuilder* builder, WGPUVertexBufferLayout* layout);
+// Append a layout for the next buffer slot (set_vertex_buffer resets to slot 0 only).
+// Layouts are copied; their attribute arrays must live until the pipeline is built
+void ug_pipeline_builder_add_vertex_buffer(UGPipelineBuilder* builder, WGPUVertexBufferLayout* layout);
+// Enable depth testing with the given compare function (WGPUCompareFunction_Always
+// to only write). Depth pipelines target the context's depth format unless
+// set_depth_format picks another; they can only be used in depth passes
+void ug_pipeline_builder_set_depth_test(UGPipelineBuilder* builder, WGPUCompareFunction compare, bool write);
+void ug_pipeline_builder_set_depth_format(UGPipelineBuilder* builder, WGPUTextureFormat format);
+// Defaults to the context's sample count; use 1 for pipelines drawing into
+// single-sampled offscreen targets (render graph textures, custom views)
+void ug_pipeline_builder_set_sample_count(UGPipelineBuilder* builder, uint32_t sample_count);
 void ug_pipeline_builder_enable_blending(UGPipelineBuilder* builder, bool enable);
 void ug_pipeline_builder_set_topology(UGPipelineBuilder* builder, WGPUPrimitiveTopology topology);
 // New: Add uniforms and textures directly to pipeline builder (auto-creates layouts)
@@ -157,6 +420,13 @@ void ug_pipeline_destroy(UGPipeline* pipeline);
 // Uniform buffer helpers
 UGUniformBuffer* ug_uniform_buffer_create(UGContext* context, size_t size);
 void ug_uniform_buffer_update(UGUniformBuffer* uniform, const void* data, size_t size);
+// Upload size bytes at offset (both multiples of 4 unless shadowed)
+bool ug_uniform_buffer_update_range(UGUniformBuffer* uniform, size_t offset, const void* data, size_t size);
+// Shadow mode, as for vertex buffers: writes are diffed per 4-byte word into a
+// CPU copy and flush uploads only the changed spans
+bool ug_uniform_buffer_enable_shadow(UGUniformBuffer* uniform);
+bool ug_uniform_buffer_write(UGUniformBuffer* uniform, size_t offset, const void* data, size_t size);
+void ug_uniform_buffer_flush(UGUniformBuffer* uniform);
 WGPUBuffer ug_uniform_buffer_get_handle(UGUniformBuffer* uniform);
 void ug_uniform_buffer_destroy(UGUniformBuffer* uniform);
 
@@ -180,24 +450,309 @@ typedef struct {
 
 UGVertexBuffer* ug_vertex_buffer_create(UGContext* context, size_t vertex_size, size_t max_vertices);
 void ug_vertex_buffer_set_layout(UGVertexBuffer* vb, const UGVertexAttribute* attributes, size_t attribute_count);
+// WGPUVertexStepMode_Instance turns the buffer into per-instance data (default: per vertex)
+void ug_vertex_buffer_set_step_mode(UGVertexBuffer* vb, WGPUVertexStepMode step_mode);
+// Replaces the contents with vertex_count vertices, growing the buffer if needed
 void ug_vertex_buffer_update(UGVertexBuffer* vb, const void* data, size_t vertex_count);
-WGPUBuffer ug_vertex_buffer_get_handle(UGVertexBuffer* vb);
+// Growth policy, applied by ug_vertex_buffer_update. An update larger than the
+// capacity reallocates at double the capacity (or the update size, if larger).
+// This changes the handle and invalidates bundles recorded against the buffer.
+// Updates are only truncated with growth off or at max_vertices
+typedef struct {
+    bool grow;                  // Default true
+    size_t max_vertices;        // Growth limit (0 = none)
+    // Shrink back towards the created capacity after this many updates in a
+    // row use under a quarter of the buffer (0 = never shrink, the default)
+    uint32_t shrink_after;
+} UGVertexBufferGrowth;
+void ug_vertex_buffer_set_growth(UGVertexBuffer* vb, const UGVertexBufferGrowth* growth);
+// Upload vertices at first_vertex, leaving the rest of the buffer as is. Must
+// fit the current capacity (ranges never grow the buffer)
+bool ug_vertex_buffer_update_range(UGVertexBuffer* vb, size_t first_vertex, const void* data, size_t vertex_count);
+// Shadow mode keeps a CPU copy of the buffer. Writes are compared against it
+// per vertex, and only vertices that changed are recorded as dirty spans.
+// Nearby spans are coalesced, and flush uploads the spans. update and
+// update_range then upload only what changed (flushing at once); write defers
+// until ug_vertex_buffer_flush, so many small edits become a few uploads
+// (without a shadow copy, write uploads at once like update_range)
+bool ug_vertex_buffer_enable_shadow(UGVertexBuffer* vb);
+bool ug_vertex_buffer_write(UGVertexBuffer* vb, size_t first_vertex, const void* data, size_t vertex_count);
+void ug_vertex_buffer_flush(UGVertexBuffer* vb);
+size_t ug_vertex_buffer_get_capacity(UGVertexBuffer* vb);             // In vertices
+size_t ug_vertex_buffer_get_vertex_size(UGVertexBuffer* vb);          // In bytes
+size_t ug_vertex_buffer_get_high_water_mark(UGVertexBuffer* vb);      // Largest update, in vertices
+void ug_vertex_buffer_reset_high_water_mark(UGVertexBuffer* vb);
+WGPUBuffer ug_vertex_buffer_get_handle(UGVertexBuffer* vb);             // Changes when the buffer grows or shrinks
 WGPUVertexBufferLayout* ug_vertex_buffer_get_layout(UGVertexBuffer* vb);
 void ug_vertex_buffer_destroy(UGVertexBuffer* vb);
 
+// Stream vertex buffer - a ring that each frame appends its batches to, so
+// writes never touch vertices an earlier frame still in flight is reading.
+// Space is reclaimed as frame slots are recycled. ring_vertices should hold
+// frames_in_flight frames of data
+UGVertexBuffer* ug_vertex_buffer_create_stream(UGContext* context, size_t vertex_size, size_t ring_vertices);
+// Append a batch for this frame. out_first_vertex receives the batch's first
+// vertex: draw it with ug_render_pass_draw_range or bind the buffer at
+// first_vertex * vertex_size. Batches appended back to back are contiguous
+// (except at the ring's wrap point), so their draws merge. Returns false
+// when the ring is full
+bool ug_vertex_buffer_append(UGVertexBuffer* vb, UGRenderFrame* frame, const void* data, size_t vertex_count,
+                             uint32_t* out_first_vertex);
+
 // Convenience functions for standard vertex formats (auto-sets layout)
 UGVertexBuffer* ug_vertex_buffer_create_2d_color(UGContext* context, size_t max_vertices);
 UGVertexBuffer* ug_vertex_buffer_create_2d_textured(UGContext* context, size_t max_vertices);
 
+// Index buffer - 16-bit (WGPUIndexFormat_Uint16) or 32-bit (WGPUIndexFormat_Uint32) indices
+UGIndexBuffer* ug_index_buffer_create(UGContext* context, WGPUIndexFormat format, size_t max_indices);
+void ug_index_buffer_update(UGIndexBuffer* ib, const void* data, size_t index_count);
+WGPUBuffer ug_index_buffer_get_handle(UGIndexBuffer* ib);
+WGPUIndexFormat ug_index_buffer_get_format(UGIndexBuffer* ib);
+size_t ug_index_buffer_get_capacity(UGIndexBuffer* ib);
+void ug_index_buffer_destroy(UGIndexBuffer* ib);
+
+// Indirect argument buffer - draw commands the GPU reads at draw time, filled
+// from the CPU with ug_indirect_buffer_update or by a compute pass (the buffer
+// has storage usage). Layouts match WebGPU's indirect argument structs
+typedef struct {
+    uint32_t vertex_count;
+    uint32_t instance_count;
+    uint32_t first_vertex;
+    uint32_t first_instance;
+} UGDrawIndirectArgs;
+
+typedef struct {
+    uint32_t index_count;
+    uint32_t instance_count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t first_instance;
+} UGDrawIndexedIndirectArgs;
+
+// indexed selects UGDrawIndexedIndirectArgs commands instead of UGDrawIndirectArgs
+UGIndirectBuffer* ug_indirect_buffer_create(UGContext* context, bool indexed, size_t max_commands);
+void ug_indirect_buffer_update(UGIndirectBuffer* ib, const void* commands, size_t first_command,
+                               size_t command_count);
+WGPUBuffer ug_indirect_buffer_get_handle(UGIndirectBuffer* ib);
+bool ug_indirect_buffer_is_indexed(UGIndirectBuffer* ib);
+size_t ug_indirect_buffer_get_capacity(UGIndirectBuffer* ib);
+size_t ug_indirect_buffer_get_command_size(UGIndirectBuffer* ib);  // Bytes per command
+void ug_indirect_buffer_destroy(UGIndirectBuffer* ib);
+
+// Staging belt - uploads written straight into mapped staging memory instead
+// of being copied by wgpuQueueWriteBuffer. alloc returns a pointer into a
+// mapped MapWrite|CopySrc chunk to fill before finish; finish unmaps the
+// chunks and records their copies in an encoder submitted ahead of all the
+// frame's commands (command lists included), so every pass of the frame sees
+// the new contents. Chunks are mapped again after submit and reused once the
+// GPU is done with them
+#define UG_STAGING_BELT_DEFAULT_CHUNK_SIZE (1024 * 1024)
+UGStagingBelt* ug_staging_belt_create(UGContext* context, size_t chunk_size);  // 0 = default
+// target needs CopyDst usage; target_offset and size must be multiples of 4.
+// Larger than a chunk gets a dedicated chunk
+void* ug_staging_belt_alloc(UGStagingBelt* belt, UGRenderFrame* frame, WGPUBuffer target,
+                            uint64_t target_offset, size_t size);
+// Space for vertex_count vertices copied to first_vertex of vb. Must fit the
+// current capacity; shadowed and stream buffers are rejected
+void* ug_staging_belt_alloc_vertices(UGStagingBelt* belt, UGRenderFrame* frame, UGVertexBuffer* vb,
+                                     size_t first_vertex, size_t vertex_count);
+void ug_staging_belt_finish(UGStagingBelt* belt, UGRenderFrame* frame);
+size_t ug_staging_belt_get_chunk_count(UGStagingBelt* belt);
+void ug_staging_belt_destroy(UGStagingBelt* belt);
+
 // Render pass - simplified render pass management
+// The pass remembers the bound pipeline, bind groups and vertex/index buffers:
+// setting what is already bound is dropped, and a draw of the same range over
+// the instances right after the previous one's is merged into it. A draw whose
+// range starts where the previous one ended (with no state change between) is
+// merged too, if the pipeline was set with a list topology (see below)
+#define UG_RENDER_PASS_MAX_BIND_GROUPS 4
+#define UG_RENDER_PASS_MAX_VERTEX_BUFFERS 8
 UGRenderPass* ug_render_pass_begin(UGRenderFrame* frame, float r, float g, float b, float a);
+// Render into view instead of the frame's view (NULL = the frame's view);
+// clear false keeps the view's contents and ignores the color
+UGRenderPass* ug_render_pass_begin_target(UGRenderFrame* frame, WGPUTextureView view, bool clear,
+                                          float r, float g, float b, float a);
+// Depth/stencil attachment of a depth pass
+typedef struct {
+    WGPUTextureView view;       // NULL = the context's depth buffer
+    WGPUTextureFormat format;   // Format of view; ignored for the context's buffer
+    bool clear;                 // Clear to clear_depth/clear_stencil instead of loading
+    float clear_depth;          // Usually 1.0 (far plane) with WGPUCompareFunction_Less
+    uint32_t clear_stencil;
+    bool discard;               // Drop the contents at the end of the pass
+} UGDepthAttachment;
+// begin_target with a depth attachment (depth NULL = none). Returns NULL if the
+// context's depth buffer can't be created
+UGRenderPass* ug_render_pass_begin_depth(UGRenderFrame* frame, WGPUTextureView view, bool clear,
+                                         float r, float g, float b, float a, const UGDepthAttachment* depth);
 void ug_render_pass_set_pipeline(UGRenderPass* pass, WGPURenderPipeline pipeline);
-void ug_render_pass_set_vertex_buffer(UGRenderPass* pass, UGVertexBuffer* vertex_buffer);
+// Also tells the pass the pipeline's topology. With a list topology, back-to-back
+// single-instance draws of whole primitives merge; ug_render_pass_set_pipeline
+// (topology unknown) and strip topologies never merge ranges
+void ug_render_pass_set_pipeline_topology(UGRenderPass* pass, WGPURenderPipeline pipeline,
+                                          WGPUPrimitiveTopology topology);
+void ug_render_pass_set_vertex_buffer(UGRenderPass* pass, UGVertexBuffer* vertex_buffer);  // Slot 0, offset 0
+void ug_render_pass_set_vertex_buffer_slot(UGRenderPass* pass, uint32_t slot,
+                                           UGVertexBuffer* vertex_buffer, uint64_t offset);
+void ug_render_pass_set_index_buffer(UGRenderPass* pass, UGIndexBuffer* index_buffer, uint64_t offset);
 void ug_render_pass_set_bind_group(UGRenderPass* pass, uint32_t group_index, WGPUBindGroup bind_group);
 void ug_render_pass_draw(UGRenderPass* pass, uint32_t vertex_count);
+void ug_render_pass_draw_range(UGRenderPass* pass, uint32_t first_vertex, uint32_t vertex_count);
 void ug_render_pass_draw_indexed(UGRenderPass* pass, uint32_t index_count);
+void ug_render_pass_draw_indexed_range(UGRenderPass* pass, uint32_t first_index, uint32_t index_count,
+                                       int32_t base_vertex);
+// Instanced draws; arguments in WebGPU order. Vertex buffers whose layout uses
+// WGPUVertexStepMode_Instance advance once per instance
+void ug_render_pass_draw_instanced(UGRenderPass* pass, uint32_t vertex_count, uint32_t instance_count,
+                                   uint32_t first_vertex, uint32_t first_instance);
+void ug_render_pass_draw_indexed_instanced(UGRenderPass* pass, uint32_t index_count, uint32_t instance_count,
+                                           uint32_t first_index, int32_t base_vertex, uint32_t first_instance);
+// Draw quads written by the 4-vertex emitters (4 vertices per quad from the
+// bound vertex buffer) with the context's quad index buffer
+#define UG_QUAD_INDEX_MAX_QUADS 16384
+void ug_render_pass_draw_quads(UGRenderPass* pass, uint32_t first_quad, uint32_t quad_count);
+// Indirect draws read their arguments from an indirect buffer; indexed buffers
+// draw with the bound index buffer. Frame counters count one draw per command
+void ug_render_pass_draw_indirect(UGRenderPass* pass, UGIndirectBuffer* commands, uint32_t command_index);
+// command_count commands in one call with wgpu-native, one call per command otherwise
+void ug_render_pass_multi_draw_indirect(UGRenderPass* pass, UGIndirectBuffer* commands,
+                                        uint32_t first_command, uint32_t command_count);
+// Draws min(count, max_count) commands, count being the uint32 at count_offset
+// in count_buffer. Returns false (and draws nothing) without device support.
+// Counted as max_count draws, since the real count is only known to the GPU
+bool ug_render_pass_multi_draw_indirect_count(UGRenderPass* pass, UGIndirectBuffer* commands,
+                                              uint32_t first_command, uint32_t max_count,
+                                              WGPUBuffer count_buffer, uint64_t count_offset);
+// Replay a recorded bundle. Returns false (and draws nothing) if the bundle has
+// been invalidated. The pass forgets its bound state afterwards, as WebGPU does
+bool ug_render_pass_execute_bundle(UGRenderPass* pass, UGRenderBundle* bundle);
 void ug_render_pass_end(UGRenderPass* pass);
 
+// Command lists - secondary command encoders for recording on worker threads
+// Create them on the frame's thread, give each to one worker (typically a job
+// on the frame's job counter) and let ug_end_render_frame submit them after the
+// jobs finish. Submission order is by order: negative lists run before the
+// frame's own encoder, the others after it; ties keep creation order.
+// Each list records one pass at a time, ended with ug_render_pass_end. List
+// passes get no GPU profiler timestamps, and buffer uploads belong on the
+// frame's thread
+#define UG_MAX_COMMAND_LISTS 16
+UGCommandList* ug_render_frame_create_command_list(UGRenderFrame* frame, int32_t order);
+// For lists whose passes use the context's depth buffer (depth->view NULL);
+// the buffer is resolved here, on the frame's thread
+UGCommandList* ug_render_frame_create_depth_command_list(UGRenderFrame* frame, int32_t order);
+// Same arguments as ug_render_pass_begin_depth (view NULL = the frame's view)
+UGRenderPass* ug_command_list_begin_pass(UGCommandList* list, WGPUTextureView view, bool clear,
+                                         float r, float g, float b, float a, const UGDepthAttachment* depth);
+// For copies and compute work recorded alongside the list's passes
+WGPUCommandEncoder ug_command_list_get_encoder(UGCommandList* list);
+
+// Render bundles - record static draw sequences (backgrounds, HUD frames,
+// tilemaps) once and replay them in any render pass with one call
+// Bundles are compatible with passes from ug_render_pass_begin on the same
+// context. The bundle keeps its pipelines and bind groups alive; destroying a
+// vertex or index buffer it reads invalidates it, after which it must be re-recorded
+UGRenderBundleBuilder* ug_render_bundle_builder_create(UGContext* context);
+// For passes begun with the context's depth buffer (ug_render_pass_begin_depth)
+UGRenderBundleBuilder* ug_render_bundle_builder_create_depth(UGContext* context);
+void ug_render_bundle_builder_set_pipeline(UGRenderBundleBuilder* builder, WGPURenderPipeline pipeline);
+void ug_render_bundle_builder_set_bind_group(UGRenderBundleBuilder* builder, uint32_t group_index,
+                                             WGPUBindGroup bind_group);
+void ug_render_bundle_builder_set_vertex_buffer(UGRenderBundleBuilder* builder, uint32_t slot,
+                                                UGVertexBuffer* vertex_buffer, uint64_t offset);
+void ug_render_bundle_builder_set_index_buffer(UGRenderBundleBuilder* builder, UGIndexBuffer* index_buffer,
+                                               uint64_t offset);
+void ug_render_bundle_builder_draw(UGRenderBundleBuilder* builder, uint32_t first_vertex, uint32_t vertex_count);
+void ug_render_bundle_builder_draw_indexed(UGRenderBundleBuilder* builder, uint32_t first_index,
+                                           uint32_t index_count, int32_t base_vertex);
+// Finish recording. A builder builds once; destroy it afterwards either way
+UGRenderBundle* ug_render_bundle_builder_build(UGRenderBundleBuilder* builder);
+void ug_render_bundle_builder_destroy(UGRenderBundleBuilder* builder);
+bool ug_render_bundle_is_valid(UGRenderBundle* bundle);
+WGPURenderBundle ug_render_bundle_get_handle(UGRenderBundle* bundle);  // NULL once invalidated
+uint32_t ug_render_bundle_get_draw_count(UGRenderBundle* bundle);
+void ug_render_bundle_destroy(UGRenderBundle* bundle);
+
+// Draw queue - collects draws from independent systems, sorts them by a 64-bit
+// key and replays them into a render pass, so draws sharing a pipeline and
+// bind groups end up adjacent (and contiguous ones merge). Sorting is stable:
+// equal keys keep submission order. Not thread-safe
+#define UG_DRAW_PACKET_BIND_GROUPS 2
+#define UG_DRAW_PACKET_VERTEX_BUFFERS 2
+typedef struct {
+    uint64_t sort_key;              // See ug_draw_key; any ordering the caller likes works
+    WGPURenderPipeline pipeline;
+    WGPUPrimitiveTopology topology; // The pipeline's; Undefined (0) = unknown, ranges don't merge
+    WGPUBindGroup bind_groups[UG_DRAW_PACKET_BIND_GROUPS];          // NULL = leave unset
+    UGVertexBuffer* vertex_buffers[UG_DRAW_PACKET_VERTEX_BUFFERS];  // NULL = leave unset
+    uint64_t vertex_offsets[UG_DRAW_PACKET_VERTEX_BUFFERS];
+    UGIndexBuffer* index_buffer;    // NULL = non-indexed draw
+    uint32_t first;                 // First vertex, or first index when indexed
+    uint32_t count;                 // Vertex or index count
+    int32_t base_vertex;            // Indexed draws only
+    uint32_t first_instance;
+    uint32_t instance_count;        // 0 = 1
+} UGDrawPacket;
+
+UGDrawQueue* ug_draw_queue_create(size_t initial_capacity);
+void ug_draw_queue_destroy(UGDrawQueue* queue);
+bool ug_draw_queue_reserve(UGDrawQueue* queue, size_t capacity);
+// The packet is copied. Returns false if the queue could not grow
+bool ug_draw_queue_push(UGDrawQueue* queue, const UGDrawPacket* packet);
+size_t ug_draw_queue_get_count(UGDrawQueue* queue);
+void ug_draw_queue_clear(UGDrawQueue* queue);
+// Radix-sort the queued packets, record them into pass and empty the queue
+void ug_draw_queue_submit(UGDrawQueue* queue, UGRenderPass* pass);
+// Standard key: layer (most significant), then opaque before translucent.
+// Opaque draws sort by pipeline, material (texture/bind group) and then front
+// to back; translucent ones back to front first. pipeline_id (12 bits) and
+// material_id (16 bits) are small caller-assigned ids; depth is 0 (near) to 1 (far)
+uint64_t ug_draw_key(uint8_t layer, bool translucent, uint16_t pipeline_id, uint16_t material_id, float depth);
+
+// Render graph - multi-pass rendering (offscreen layers, bloom, post-processing)
+// over a UGRenderFrame. Rebuild it each frame between ug_render_graph_begin and
+// ug_render_graph_execute: passes declare the one texture they render into and
+// the textures they sample. Declaration order defines what a read sees (the
+// latest earlier write). Execute culls passes whose output never reaches the
+// backbuffer or an imported texture, orders the rest and runs each callback
+// inside a render pass on its target
+// Transient textures are pooled by the graph; transients with the same size and
+// format share one GPU texture when their lifetimes don't overlap, so their
+// contents only live from their first write to their last read. The first
+// write of a transient always clears. Names must outlive the execute
+#define UG_RENDER_GRAPH_MAX_PASSES 64
+#define UG_RENDER_GRAPH_MAX_TEXTURES 64
+#define UG_RENDER_GRAPH_MAX_READS 8
+#define UG_RENDER_GRAPH_INVALID UINT32_MAX
+#define UG_RENDER_GRAPH_BACKBUFFER 0    // The frame's view; can be written but not read
+typedef uint32_t UGRenderGraphTexture;
+typedef uint32_t UGRenderGraphPass;
+typedef void (*UGRenderGraphPassCallback)(UGRenderGraph* graph, UGRenderPass* pass, void* userdata);
+
+UGRenderGraph* ug_render_graph_create(UGContext* context);
+void ug_render_graph_destroy(UGRenderGraph* graph);   // Releases the texture pool
+void ug_render_graph_begin(UGRenderGraph* graph, UGRenderFrame* frame);
+UGRenderFrame* ug_render_graph_get_frame(UGRenderGraph* graph);
+// width/height 0 = surface size; WGPUTextureFormat_Undefined = surface format
+UGRenderGraphTexture ug_render_graph_create_texture(UGRenderGraph* graph, const char* name,
+                                                    uint32_t width, uint32_t height, WGPUTextureFormat format);
+// A texture owned by the caller; writes to it are kept like backbuffer writes
+UGRenderGraphTexture ug_render_graph_import_texture(UGRenderGraph* graph, const char* name, WGPUTextureView view);
+UGRenderGraphPass ug_render_graph_add_pass(UGRenderGraph* graph, const char* name,
+                                           UGRenderGraphPassCallback callback, void* userdata);
+void ug_render_graph_pass_read(UGRenderGraph* graph, UGRenderGraphPass pass, UGRenderGraphTexture texture);
+// Render into texture keeping (write) or clearing (clear) its contents
+void ug_render_graph_pass_write(UGRenderGraph* graph, UGRenderGraphPass pass, UGRenderGraphTexture texture);
+void ug_render_graph_pass_clear(UGRenderGraph* graph, UGRenderGraphPass pass, UGRenderGraphTexture texture,
+                                float r, float g, float b, float a);
+// Returns false if a declaration was invalid or a texture couldn't be created
+bool ug_render_graph_execute(UGRenderGraph* graph);
+// View of a texture; for transients only valid inside pass callbacks of this execute
+WGPUTextureView ug_render_graph_get_view(UGRenderGraph* graph, UGRenderGraphTexture texture);
+bool ug_render_graph_pass_is_culled(UGRenderGraph* graph, UGRenderGraphPass pass);  // After execute
+uint32_t ug_render_graph_get_pool_texture_count(UGRenderGraph* graph);
+
 // Geometry helpers - standard vertex formats and primitive generation
 // Standard 2D vertex format: position (vec2) + color (vec3)
 typedef struct {
@@ -218,6 +773,13 @@ void ug_add_rect_2d_color(UGVertex2DColor* vertices, size_t* count,
                           float x, float y, float w, float h,
                           float r, float g, float b);
 
+// 4-vertex rectangle variants: each rectangle writes its 4 corners (top-left,
+// top-right, bottom-left, bottom-right) instead of 6 triangle vertices. Draw
+// them with ug_render_pass_draw_quads, which supplies the shared quad indices
+void ug_add_rect_2d_color_indexed(UGVertex2DColor* vertices, size_t* count,
+                                  float x, float y, float w, float h,
+                                  float r, float g, float b);
+
 // Add a circle or ellipse to a vertex array (2D position + color format)
 // x, y: center position
 // width: radius in x direction (or radius for perfect circle if height is 0)
@@ -228,12 +790,39 @@ void ug_add_circle_2d_color(UGVertex2DColor* vertices, size_t* count,
                             float x, float y, float width, float height,
                             float r, float g, float b, int segments);
 
+// Shape descriptions for bulk geometry generation
+typedef struct {
+    float x, y;           // Center position
+    float w, h;           // Half-width and half-height
+    float r, g, b;
+} UGRect2D;
+
+typedef struct {
+    float x, y;           // Center position
+    float width, height;  // Radii, as for ug_add_circle_2d_color
+    float r, g, b;
+} UGCircle2D;
+
+// Bulk versions of the emitters above. Every shape produces a fixed number of
+// vertices (6 per rect, 3 * segments per circle) in input order, so large
+// batches are split across the job system; jobs may be NULL to run inline.
+void ug_add_rects_2d_color(UGVertex2DColor* vertices, size_t* count,
+                           const UGRect2D* rects, size_t rect_count, UGJobSystem* jobs);
+void ug_add_circles_2d_color(UGVertex2DColor* vertices, size_t* count,
+                             const UGCircle2D* circles, size_t circle_count,
+                             int segments, UGJobSystem* jobs);
+void ug_add_rects_2d_color_indexed(UGVertex2DColor* vertices, size_t* count,
+                                   const UGRect2D* rects, size_t rect_count, UGJobSystem* jobs);
+
 // Add a rectangle to a vertex array (2D position + UV format)
 // x, y: center position, w, h: half-width and half-height
 // u0, v0, u1, v1: texture coordinates for the rectangle
 void ug_add_rect_2d_textured(UGVertex2DTextured* vertices, size_t* count,
                              float x, float y, float w, float h,
                              float u0, float v0, float u1, float v1);
+void ug_add_rect_2d_textured_indexed(UGVertex2DTextured* vertices, size_t* count,
+                                     float x, float y, float w, float h,
+                                     float u0, float v0, float u1, float v1);
 
 // Add a circle or ellipse to a vertex array (2D position + UV format)
 // x, y: center position
@@ -252,6 +841,12 @@ void ug_add_circle_2d_textured(UGVertex2DTextured* vertices, size_t* count,
 // Returns NULL on failure
 UGTexture* ug_texture_create_from_file(UGContext* context, const char* filepath);
 
+// Load several textures at once, decoding the files in parallel on the
+// context's job system. out_textures receives one entry per path (NULL for
+// files that failed); returns false if any failed
+bool ug_texture_create_from_files(UGContext* context, const char* const* filepaths, size_t count,
+                                  UGTexture** out_textures);
+
 // Destroy texture and free all resources
 void ug_texture_destroy(UGTexture* texture);
 
@@ -285,6 +880,9 @@ void ug_sprite_sheet_destroy(UGSpriteSheet* sheet);
 // w, h: Half-width and half-height
 void ug_sprite_sheet_add_sprite(UGSpriteSheet* sheet, UGVertex2DTextured* vertices, size_t* count,
                                 int sprite_index, float x, float y, float w, float h);
+// 4-vertex variant for ug_render_pass_draw_quads (count is incremented by 4)
+void ug_sprite_sheet_add_sprite_indexed(UGSpriteSheet* sheet, UGVertex2DTextured* vertices, size_t* count,
+                                        int sprite_index, float x, float y, float w, float h);
 
 // Get the texture associated with this sprite sheet
 UGTexture* ug_sprite_sheet_get_texture(UGSpriteSheet* sheet);
@@ -311,7 +909,10 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
 void ug_font_atlas_destroy(UGFontAtlas* atlas);
 
 // Get the pre-configured render pipeline for text rendering
+// Both follow the context's sample count; use the depth pipeline in depth passes
+// (it ignores and keeps the depth buffer)
 WGPURenderPipeline ug_font_atlas_get_pipeline(UGFontAtlas* atlas);
+WGPURenderPipeline ug_font_atlas_get_depth_pipeline(UGFontAtlas* atlas);
 
 // Get the pre-configured bind group (contains texture and sampler)
 WGPUBindGroup ug_font_atlas_get_bind_group(UGFontAtlas* atlas);
@@ -340,6 +941,14 @@ void ug_font_atlas_add_text(UGFontAtlas* atlas, void* vertices, size_t* count,
                             const char* text, float x, float y, float pixel_height,
                             float r, float g, float b, float a);
 
+// 4-vertex variants for ug_render_pass_draw_quads: each character adds 4 vertices
+void ug_font_atlas_add_text_px_indexed(UGFontAtlas* atlas, void* vertices, size_t* count,
+                                       const char* text, float x, float y, UGContext* context,
+                                       float r, float g, float b, float a);
+void ug_font_atlas_add_text_indexed(UGFontAtlas* atlas, void* vertices, size_t* count,
+                                    const char* text, float x, float y, float pixel_height,
+                                    float r, float g, float b, float a);
+
 // Get the vertex size for text rendering (for creating vertex buffers)
 size_t ug_font_atlas_get_vertex_size(void);
 
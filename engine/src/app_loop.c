@@ -1,39 +1,583 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#endif
+
+// Loop bookkeeping shared by the ug_run variants
+typedef struct {
+    UGWindow* window;
+    bool headless;
+    uint64_t frame_limit;
+    uint64_t frames_rendered;
+    UGInputLog* input_log;      // Recording or replaying, if set up on the context
+} LoopState;
+
+static bool loop_init(UGContext* context, LoopState* loop) {
+    // Headless contexts have no window; they run until the frame limit is hit
+    loop->window = ug_context_get_window(context);
+    loop->headless = ug_context_is_headless(context);
+    if (!loop->window && !loop->headless) {
+        return false;
+    }
+
+    // A replayed log ends the run by itself
+    loop->input_log = ug_context_get_input_log(context);
+    loop->frame_limit = ug_context_get_frame_limit(context);
+    if (loop->headless && loop->frame_limit == 0 && !ug_input_log_is_replaying(loop->input_log)) {
+        return false;
+    }
+    loop->frames_rendered = 0;
+    return true;
+}
+
+// Window closed or frame limit reached
+static bool loop_done(LoopState* loop) {
+    if (!loop->headless && ug_window_should_close(loop->window)) {
+        return true;
+    }
+    if (ug_input_log_finished(loop->input_log)) {
+        return true;
+    }
+    return loop->frame_limit && loop->frames_rendered >= loop->frame_limit;
+}
+
+// Time since the previous call in nanoseconds. Goes through the input log so
+// a recording captures it and a replay substitutes the logged value
+static uint64_t loop_frame_delta(LoopState* loop, uint64_t* last_time) {
+    uint64_t current_time = ug_get_time_ns();
+    uint64_t delta = current_time - *last_time;
+    *last_time = current_time;
+    return ug_input_log_frame(loop->input_log, delta);
+}
+
+// Checks for window close or the frame limit, then polls window events
+static bool loop_next(LoopState* loop) {
+    if (loop_done(loop)) {
+        return false;
+    }
+
+    if (loop->window) {
+        UG_PROFILE_BEGIN("poll_events");
+        ug_window_poll_events(loop->window);
+        UG_PROFILE_END();
+    }
+    return true;
+}
+
+static void loop_finish(UGContext* context, LoopState* loop) {
+    // Nothing paces a headless run, so make sure the GPU has actually finished
+    // the frames before returning control (and timings) to the caller
+    if (loop->headless) {
+        ug_context_wait_idle(context);
+    }
+}
 
 void ug_run(UGContext* context, UGRenderCallback render_callback, void* userdata) {
     if (!context || !render_callback) {
         return;
     }
 
-    UGWindow* window = ug_context_get_window(context);
-    if (!window) {
+    LoopState loop;
+    if (!loop_init(context, &loop)) {
         return;
     }
 
+    UG_PROFILE_BEGIN("ug_run");
+
     // Track time for delta_time calculation
-    double last_time = ug_get_time();
+    uint64_t last_time = ug_get_time_ns();
 
     // Main loop
-    while (!ug_window_should_close(window)) {
-        ug_window_poll_events(window);
+    while (true) {
+        UG_PROFILE_BEGIN("frame");
+        if (!loop_next(&loop)) {
+            UG_PROFILE_END();
+            break;
+        }
 
         // Calculate delta time
-        double current_time = ug_get_time();
-        float delta_time = (float)(current_time - last_time);
-        last_time = current_time;
+        float delta_time = (float)((double)loop_frame_delta(&loop, &last_time) * 1e-9);
 
         // Begin render frame - handles surface texture acquisition and setup
         UGRenderFrame* frame = ug_begin_render_frame(context);
         if (!frame) {
+            UG_PROFILE_END();
+            if (loop.headless) {
+                break;
+            }
             continue;
         }
 
         // Call user's render callback with delta_time
+        UG_PROFILE_BEGIN("render_callback");
         render_callback(context, frame, delta_time, userdata);
+        UG_PROFILE_END();
 
         // End frame - handles command submission and presentation
         ug_end_render_frame(frame);
+        loop.frames_rendered++;
+        UG_PROFILE_END();
+    }
+
+    loop_finish(context, &loop);
+    UG_PROFILE_END();
+}
+
+void ug_run_fixed(UGContext* context, const UGFixedStepConfig* config,
+                  UGUpdateCallback update_callback, UGFixedRenderCallback render_callback,
+                  void* userdata) {
+    if (!context || !update_callback || !render_callback) {
+        return;
+    }
+
+    UGFixedStepConfig settings = {
+        .step_seconds = UG_FIXED_STEP_DEFAULT_SECONDS,
+        .max_frame_seconds = UG_FIXED_STEP_DEFAULT_MAX_FRAME_SECONDS,
+        .max_steps_per_frame = UG_FIXED_STEP_DEFAULT_MAX_STEPS,
+    };
+    if (config) {
+        if (config->step_seconds > 0.0) settings.step_seconds = config->step_seconds;
+        if (config->max_frame_seconds > 0.0) settings.max_frame_seconds = config->max_frame_seconds;
+        if (config->max_steps_per_frame > 0) settings.max_steps_per_frame = config->max_steps_per_frame;
+    }
+
+    LoopState loop;
+    if (!loop_init(context, &loop)) {
+        return;
+    }
+
+    UG_PROFILE_BEGIN("ug_run_fixed");
+
+    uint64_t last_time = ug_get_time_ns();
+    double accumulator = 0.0;
+    float step = (float)settings.step_seconds;
+
+    while (true) {
+        UG_PROFILE_BEGIN("frame");
+        if (!loop_next(&loop)) {
+            UG_PROFILE_END();
+            break;
+        }
+
+        double frame_seconds = (double)loop_frame_delta(&loop, &last_time) * 1e-9;
+
+        // A long stall (debugger, window drag, load hitch) is dropped rather
+        // than simulated, so the loop can't fall into a spiral of death
+        if (frame_seconds > settings.max_frame_seconds) {
+            frame_seconds = settings.max_frame_seconds;
+        }
+        accumulator += frame_seconds;
+
+        UG_PROFILE_BEGIN("update");
+        uint32_t steps = 0;
+        while (accumulator >= settings.step_seconds && steps < settings.max_steps_per_frame) {
+            update_callback(context, step, userdata);
+            accumulator -= settings.step_seconds;
+            steps++;
+        }
+        UG_PROFILE_END();
+
+        // Out of catch-up budget: discard whole steps that are still owed so
+        // update cost stays bounded, keeping the fractional part for alpha
+        if (accumulator >= settings.step_seconds) {
+            accumulator -= settings.step_seconds * (double)(uint64_t)(accumulator / settings.step_seconds);
+        }
+
+        UGRenderFrame* frame = ug_begin_render_frame(context);
+        if (!frame) {
+            UG_PROFILE_END();
+            if (loop.headless) {
+                break;
+            }
+            continue;
+        }
+
+        float alpha = (float)(accumulator / settings.step_seconds);
+        UG_PROFILE_BEGIN("render_callback");
+        render_callback(context, frame, alpha, userdata);
+        UG_PROFILE_END();
+
+        ug_end_render_frame(frame);
+        loop.frames_rendered++;
+        UG_PROFILE_END();
+    }
+
+    loop_finish(context, &loop);
+    UG_PROFILE_END();
+}
+
+void ug_run_on_demand(UGContext* context, UGRenderCallback render_callback, void* userdata) {
+    if (!context || !render_callback) {
+        return;
+    }
+
+    LoopState loop;
+    if (!loop_init(context, &loop)) {
+        return;
+    }
+
+    UG_PROFILE_BEGIN("ug_run_on_demand");
+
+    uint64_t last_time = ug_get_time_ns();
+    uint64_t events_seen = ug_window_get_event_count(loop.window);
+    bool redraw = true;  // Always draw the first frame
+
+    while (!loop_done(&loop)) {
+        uint64_t events = ug_window_get_event_count(loop.window);
+        if (events != events_seen) {
+            events_seen = events;
+            redraw = true;
+        }
+
+        uint64_t deadline = 0;
+        if (ug_context_take_redraw_request(context, ug_get_time_ns(), &deadline) || loop.headless ||
+            ug_input_log_is_replaying(loop.input_log)) {
+            redraw = true;
+        }
+
+        // Nothing to draw: sleep until an event, a redraw request or the next timer
+        if (!redraw) {
+            double timeout = -1.0;
+            if (deadline) {
+                uint64_t now = ug_get_time_ns();
+                timeout = deadline > now ? (double)(deadline - now) * 1e-9 : 0.0;
+            }
+            UG_PROFILE_BEGIN("wait_events");
+            ug_window_wait_events(loop.window, timeout);
+            UG_PROFILE_END();
+            continue;
+        }
+        redraw = false;
+
+        UG_PROFILE_BEGIN("frame");
+
+        // Events pumped here are handled by this frame, so they don't need another
+        if (loop.window) {
+            UG_PROFILE_BEGIN("poll_events");
+            ug_window_poll_events(loop.window);
+            UG_PROFILE_END();
+            events_seen = ug_window_get_event_count(loop.window);
+        }
+
+        // delta_time spans the idle period since the previous drawn frame
+        float delta_time = (float)((double)loop_frame_delta(&loop, &last_time) * 1e-9);
+
+        // A minimized window has no surface to draw to; restoring it sends an event
+        UGRenderFrame* frame = ug_begin_render_frame(context);
+        if (!frame) {
+            UG_PROFILE_END();
+            if (loop.headless) {
+                break;
+            }
+            continue;
+        }
+
+        UG_PROFILE_BEGIN("render_callback");
+        render_callback(context, frame, delta_time, userdata);
+        UG_PROFILE_END();
+
+        ug_end_render_frame(frame);
+        loop.frames_rendered++;
+        UG_PROFILE_END();
     }
+
+    loop_finish(context, &loop);
+    UG_PROFILE_END();
+}
+
+#if !defined(_WIN32)
+
+// Shared state of ug_run_threaded. Snapshot hand-off: the simulation thread
+// publishes a finished buffer as `ready`, the render thread moves it to
+// `reading` while recording, and the simulation thread only writes a buffer
+// that is neither
+typedef struct {
+    UGContext* context;
+    LoopState loop;
+    UGSimulateCallback simulate;
+    UGSnapshotRenderCallback render;
+    void* userdata;
+
+    void* snapshots[2];
+    int ready;                      // Index of the latest unconsumed snapshot, or -1
+    int reading;                    // Index the render thread is recording from, or -1
+
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;         // Any change to ready/reading/running/frames
+    pthread_mutex_t input_mutex;    // Serializes event callbacks with simulate
+    int framebuffer_width;          // Published by the main thread after each event pump
+    int framebuffer_height;
+    atomic_bool running;
+    bool simulation_done;           // A replayed input log ran out
+} ThreadedLoop;
+
+static void threaded_stop(ThreadedLoop* shared) {
+    pthread_mutex_lock(&shared->mutex);
+    atomic_store(&shared->running, false);
+    pthread_cond_broadcast(&shared->changed);
+    pthread_mutex_unlock(&shared->mutex);
+}
+
+static void* simulation_thread(void* arg) {
+    ThreadedLoop* shared = (ThreadedLoop*)arg;
+    uint64_t last_time = ug_get_time_ns();
+    int write = 0;
+
+    while (atomic_load(&shared->running)) {
+        // Wait until the buffer to write is not being rendered from
+        pthread_mutex_lock(&shared->mutex);
+        while (atomic_load(&shared->running) && (shared->reading == write || shared->ready == write)) {
+            pthread_cond_wait(&shared->changed, &shared->mutex);
+        }
+        pthread_mutex_unlock(&shared->mutex);
+        if (!atomic_load(&shared->running)) {
+            break;
+        }
+
+        // The input log sees events and deltas in the order simulate does
+        UG_PROFILE_BEGIN("simulate");
+        pthread_mutex_lock(&shared->input_mutex);
+        if (ug_input_log_finished(shared->loop.input_log)) {
+            pthread_mutex_unlock(&shared->input_mutex);
+            UG_PROFILE_END();
+            break;
+        }
+        float delta_time = (float)((double)loop_frame_delta(&shared->loop, &last_time) * 1e-9);
+        shared->simulate(shared->context, delta_time, shared->snapshots[write], shared->userdata);
+        pthread_mutex_unlock(&shared->input_mutex);
+        UG_PROFILE_END();
+
+        // Publish once the render thread has taken the previous snapshot
+        pthread_mutex_lock(&shared->mutex);
+        while (atomic_load(&shared->running) && shared->ready != -1) {
+            pthread_cond_wait(&shared->changed, &shared->mutex);
+        }
+        shared->ready = write;
+        pthread_cond_broadcast(&shared->changed);
+        pthread_mutex_unlock(&shared->mutex);
+
+        write = 1 - write;
+    }
+
+    // Let the render thread drain the last snapshot before it stops
+    pthread_mutex_lock(&shared->mutex);
+    shared->simulation_done = true;
+    pthread_cond_broadcast(&shared->changed);
+    pthread_mutex_unlock(&shared->mutex);
+    return NULL;
+}
+
+static void* render_thread(void* arg) {
+    ThreadedLoop* shared = (ThreadedLoop*)arg;
+
+    while (atomic_load(&shared->running)) {
+        if (shared->loop.frame_limit && shared->loop.frames_rendered >= shared->loop.frame_limit) {
+            threaded_stop(shared);
+            break;
+        }
+
+        pthread_mutex_lock(&shared->mutex);
+        while (atomic_load(&shared->running) && shared->ready == -1 && !shared->simulation_done) {
+            pthread_cond_wait(&shared->changed, &shared->mutex);
+        }
+        int read = shared->ready;
+        shared->reading = read;
+        shared->ready = -1;
+        int framebuffer_width = shared->framebuffer_width;
+        int framebuffer_height = shared->framebuffer_height;
+        pthread_cond_broadcast(&shared->changed);
+        pthread_mutex_unlock(&shared->mutex);
+        if (read == -1) {
+            threaded_stop(shared);
+            break;
+        }
+
+        // Frame setup sizes the depth/MSAA targets and render graph textures
+        // from the window, which must not ask GLFW from this thread
+        if (shared->loop.window) {
+            ug_window_set_cached_size(shared->loop.window, framebuffer_width, framebuffer_height);
+        }
+
+        UG_PROFILE_BEGIN("frame");
+        UGRenderFrame* frame = ug_begin_render_frame(shared->context);
+        if (frame) {
+            UG_PROFILE_BEGIN("render_callback");
+            shared->render(shared->context, frame, shared->snapshots[read], shared->userdata);
+            UG_PROFILE_END();
+            ug_end_render_frame(frame);
+        }
+        UG_PROFILE_END();
+
+        pthread_mutex_lock(&shared->mutex);
+        shared->reading = -1;
+        if (frame) {
+            shared->loop.frames_rendered++;
+        }
+        pthread_cond_broadcast(&shared->changed);
+        pthread_mutex_unlock(&shared->mutex);
+
+        if (!frame && shared->loop.headless) {
+            threaded_stop(shared);
+        }
+    }
+
+    return NULL;
+}
+
+void ug_run_threaded(UGContext* context, size_t snapshot_size, UGSimulateCallback simulate_callback,
+                     UGSnapshotRenderCallback render_callback, void* userdata) {
+    if (!context || snapshot_size == 0 || !simulate_callback || !render_callback) {
+        return;
+    }
+
+    ThreadedLoop shared = {
+        .context = context,
+        .simulate = simulate_callback,
+        .render = render_callback,
+        .userdata = userdata,
+        .ready = -1,
+        .reading = -1,
+    };
+    if (!loop_init(context, &shared.loop)) {
+        return;
+    }
+
+    shared.snapshots[0] = calloc(1, snapshot_size);
+    shared.snapshots[1] = calloc(1, snapshot_size);
+    if (!shared.snapshots[0] || !shared.snapshots[1]) {
+        free(shared.snapshots[0]);
+        free(shared.snapshots[1]);
+        return;
+    }
+
+    pthread_mutex_init(&shared.mutex, NULL);
+    pthread_mutex_init(&shared.input_mutex, NULL);
+    pthread_cond_init(&shared.changed, NULL);
+    atomic_init(&shared.running, true);
+    if (shared.loop.window) {
+        ug_window_query_size(shared.loop.window, &shared.framebuffer_width, &shared.framebuffer_height);
+        ug_window_set_cached_size(shared.loop.window, shared.framebuffer_width, shared.framebuffer_height);
+    }
+
+    UG_PROFILE_BEGIN("ug_run_threaded");
+
+    pthread_t simulation, render;
+    bool simulation_started = pthread_create(&simulation, NULL, simulation_thread, &shared) == 0;
+    bool render_started = simulation_started &&
+                          pthread_create(&render, NULL, render_thread, &shared) == 0;
+    if (!render_started) {
+        fprintf(stderr, "Failed to start loop threads\n");
+        threaded_stop(&shared);
+    }
+
+    // The main thread owns the window: pump events once per rendered frame,
+    // sleeping in between instead of spinning
+    uint64_t frames_seen = 0;
+    while (atomic_load(&shared.running)) {
+        if (shared.loop.window) {
+            UG_PROFILE_BEGIN("poll_events");
+            pthread_mutex_lock(&shared.input_mutex);
+            ug_window_poll_events(shared.loop.window);
+            pthread_mutex_unlock(&shared.input_mutex);
+            UG_PROFILE_END();
+
+            int width, height;
+            ug_window_query_size(shared.loop.window, &width, &height);
+            pthread_mutex_lock(&shared.mutex);
+            shared.framebuffer_width = width;
+            shared.framebuffer_height = height;
+            pthread_mutex_unlock(&shared.mutex);
+
+            if (ug_window_should_close(shared.loop.window)) {
+                threaded_stop(&shared);
+                break;
+            }
+        }
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 4 * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        pthread_mutex_lock(&shared.mutex);
+        while (atomic_load(&shared.running) && shared.loop.frames_rendered == frames_seen) {
+            if (pthread_cond_timedwait(&shared.changed, &shared.mutex, &deadline) != 0) {
+                break;
+            }
+        }
+        frames_seen = shared.loop.frames_rendered;
+        pthread_mutex_unlock(&shared.mutex);
+    }
+
+    if (simulation_started) pthread_join(simulation, NULL);
+    if (render_started) pthread_join(render, NULL);
+    if (shared.loop.window) {
+        ug_window_clear_cached_size(shared.loop.window);
+    }
+
+    loop_finish(context, &shared.loop);
+    UG_PROFILE_END();
+
+    pthread_cond_destroy(&shared.changed);
+    pthread_mutex_destroy(&shared.input_mutex);
+    pthread_mutex_destroy(&shared.mutex);
+    free(shared.snapshots[0]);
+    free(shared.snapshots[1]);
+}
+
+#else
+
+// No pthreads: run the same callbacks serially on the calling thread
+void ug_run_threaded(UGContext* context, size_t snapshot_size, UGSimulateCallback simulate_callback,
+                     UGSnapshotRenderCallback render_callback, void* userdata) {
+    if (!context || snapshot_size == 0 || !simulate_callback || !render_callback) {
+        return;
+    }
+
+    LoopState loop;
+    if (!loop_init(context, &loop)) {
+        return;
+    }
+
+    void* snapshot = calloc(1, snapshot_size);
+    if (!snapshot) {
+        return;
+    }
+
+    uint64_t last_time = ug_get_time_ns();
+    while (loop_next(&loop)) {
+        float delta_time = (float)((double)loop_frame_delta(&loop, &last_time) * 1e-9);
+
+        simulate_callback(context, delta_time, snapshot, userdata);
+
+        UGRenderFrame* frame = ug_begin_render_frame(context);
+        if (!frame) {
+            if (loop.headless) {
+                break;
+            }
+            continue;
+        }
+        render_callback(context, frame, snapshot, userdata);
+        ug_end_render_frame(frame);
+        loop.frames_rendered++;
+    }
+
+    loop_finish(context, &loop);
+    free(snapshot);
 }
 
+#endif
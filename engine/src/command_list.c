@@ -0,0 +1,110 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Secondary command encoder recorded on a worker thread and submitted by the
+// frame. Lists are owned by their frame slot and reused every frame
+struct UGCommandList {
+    UGRenderFrame* frame;
+    int32_t order;
+    WGPUCommandEncoder encoder;
+    UGRenderPass* pass;             // Own pass object, so lists never contend for the frame's
+    UGFrameCounters counters;       // Merged into the frame's counters on submit
+    WGPUTextureView msaa_view;      // Context targets, fetched on the frame thread
+    WGPUTextureView depth_view;
+};
+
+UGCommandList* ug_command_list_alloc(void) {
+    UGCommandList* list = (UGCommandList*)calloc(1, sizeof(UGCommandList));
+    if (!list) {
+        return NULL;
+    }
+
+    list->pass = ug_render_pass_alloc();
+    if (!list->pass) {
+        free(list);
+        return NULL;
+    }
+    return list;
+}
+
+void ug_command_list_free(UGCommandList* list) {
+    if (list) {
+        if (list->encoder) wgpuCommandEncoderRelease(list->encoder);
+        ug_render_pass_free(list->pass);
+        free(list);
+    }
+}
+
+bool ug_command_list_begin(UGCommandList* list, UGRenderFrame* frame, int32_t order, bool depth) {
+    UGContext* context = ug_render_frame_get_context(frame);
+    list->encoder = wgpuDeviceCreateCommandEncoder(ug_context_get_device(context), NULL);
+    if (!list->encoder) {
+        fprintf(stderr, "Failed to create command list encoder\n");
+        return false;
+    }
+
+    list->frame = frame;
+    list->order = order;
+    memset(&list->counters, 0, sizeof(list->counters));
+    // Both are created lazily by the context, which is not safe off the frame
+    // thread. The depth buffer is only created for lists that asked for it
+    list->msaa_view = ug_context_get_msaa_view(context);
+    list->depth_view = depth ? ug_context_get_depth_view(context) : NULL;
+    if (depth && !list->depth_view) {
+        wgpuCommandEncoderRelease(list->encoder);
+        list->encoder = NULL;
+        return false;
+    }
+    return true;
+}
+
+WGPUCommandBuffer ug_command_list_finish(UGCommandList* list, UGFrameCounters* frame_counters) {
+    if (ug_render_pass_is_recording(list->pass)) {
+        fprintf(stderr, "Command list submitted with its render pass still open\n");
+        ug_render_pass_end(list->pass);
+    }
+
+    WGPUCommandBuffer command = wgpuCommandEncoderFinish(list->encoder, NULL);
+    wgpuCommandEncoderRelease(list->encoder);
+    list->encoder = NULL;
+    list->frame = NULL;
+    ug_frame_counters_add(frame_counters, &list->counters);
+    return command;
+}
+
+int32_t ug_command_list_get_order(UGCommandList* list) {
+    return list ? list->order : 0;
+}
+
+UGRenderPass* ug_command_list_begin_pass(UGCommandList* list, WGPUTextureView view, bool clear,
+                                         float r, float g, float b, float a, const UGDepthAttachment* depth) {
+    if (!list || !list->encoder) {
+        return NULL;
+    }
+    if (ug_render_pass_is_recording(list->pass)) {
+        fprintf(stderr, "Only one render pass can be open per command list at a time\n");
+        return NULL;
+    }
+
+    if (depth && !depth->view && !list->depth_view) {
+        fprintf(stderr, "Command list has no depth buffer; create it with ug_render_frame_create_depth_command_list\n");
+        return NULL;
+    }
+
+    UGPassRecorder recorder = {
+        .encoder = list->encoder,
+        .counters = &list->counters,
+        .msaa_view = list->msaa_view,
+        .depth_view = list->depth_view,
+        .timestamps = false,
+    };
+    return ug_render_pass_begin_recording(list->pass, list->frame, &recorder, view, clear, r, g, b, a, depth);
+}
+
+WGPUCommandEncoder ug_command_list_get_encoder(UGCommandList* list) {
+    return list ? list->encoder : NULL;
+}
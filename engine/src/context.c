@@ -1,5 +1,7 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,6 +28,14 @@ typedef struct {
     bool request_ended;
 } DeviceUserData;
 
+// Engine-owned texture that follows the surface size
+typedef struct {
+    WGPUTexture texture;
+    WGPUTextureView view;
+    uint32_t width;
+    uint32_t height;
+} SurfaceTarget;
+
 struct UGContext {
     UGWindow* window;
     WGPUInstance instance;
@@ -35,6 +45,41 @@ struct UGContext {
     WGPUSurface surface;
     WGPUTextureFormat surface_format;
     WGPUPresentMode present_mode;
+
+    // Headless mode: render into an engine-owned texture instead of a surface
+    bool headless;
+    WGPUTexture offscreen_texture;
+    WGPUTextureView offscreen_view;
+    uint32_t offscreen_width;
+    uint32_t offscreen_height;
+
+    uint64_t frame_limit;   // Frames ug_run renders before returning (0 = unlimited)
+
+    // Preallocated frame slots, one per frame the GPU may have in flight
+    UGFrameRing* frame_ring;
+    uint32_t frames_in_flight;
+
+    UGGpuProfiler* gpu_profiler;  // NULL unless requested and supported
+    UGFrameStatsWindow* frame_stats;
+    UGJobSystem* job_system;
+    UGIndexBuffer* quad_index_buffer;  // Shared by every quad-emitting draw
+    bool multi_draw_indirect_count;    // Native feature enabled on the device
+
+    // Shared depth buffer and multisampled color target, created on first use
+    // and recreated when the size of the texture frames render into changes
+    uint32_t target_width;
+    uint32_t target_height;
+    WGPUTextureFormat depth_format;
+    uint32_t sample_count;
+    SurfaceTarget depth_target;
+    SurfaceTarget msaa_target;
+
+    // On-demand loop state; written from any thread
+    atomic_bool redraw_requested;
+    atomic_uint_fast64_t redraw_deadline_ns;   // Earliest timed redraw, 0 = none
+    atomic_bool animating;
+
+    UGInputLog* input_log;          // Recording or replaying, if requested
 };
 
 struct UGContextBuilder {
@@ -42,6 +87,17 @@ struct UGContextBuilder {
     WGPUPowerPreference power_preference;
     WGPUPresentMode present_mode;
     WGPUTextureFormat surface_format;
+    WGPUTextureFormat depth_format;
+    uint32_t sample_count;
+    bool headless;
+    uint32_t headless_width;
+    uint32_t headless_height;
+    uint64_t frame_limit;
+    uint32_t frames_in_flight;
+    bool gpu_profiler;
+    uint32_t worker_count;
+    const char* record_input_path;
+    const char* replay_input_path;
 };
 
 // Adapter request callback
@@ -124,17 +180,72 @@ static WGPUSurface create_surface(WGPUInstance instance, UGWindow* window) {
     return surface;
 }
 
+// Request an adapter and block until the request has completed
+static WGPUAdapter request_adapter(WGPUInstance instance, const WGPURequestAdapterOptions* options) {
+    AdapterUserData adapter_data = {0};
+    WGPURequestAdapterCallbackInfo adapter_callback_info = {
+        .mode = WGPUCallbackMode_AllowSpontaneous,
+        .callback = on_adapter_request_ended,
+        .userdata1 = &adapter_data,
+    };
+    wgpuInstanceRequestAdapter(instance, options, adapter_callback_info);
+    return adapter_data.adapter;
+}
+
+// Create the texture headless contexts render into in place of a surface
+static WGPUTexture create_offscreen_texture(WGPUDevice device, WGPUTextureFormat format,
+                                            uint32_t width, uint32_t height) {
+    WGPUTextureDescriptor texture_desc = {
+        .label = {"Offscreen Target", WGPU_STRLEN},
+        .size = {width, height, 1},
+        .format = format,
+        .usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_CopySrc |
+                 WGPUTextureUsage_TextureBinding,
+        .dimension = WGPUTextureDimension_2D,
+        .mipLevelCount = 1,
+        .sampleCount = 1,
+    };
+    return wgpuDeviceCreateTexture(device, &texture_desc);
+}
+
 // Internal context creation function
-static UGContext* create_context_internal(UGWindow* window, WGPUPowerPreference power_preference,
-                                          WGPUPresentMode present_mode, WGPUTextureFormat surface_format) {
+static UGContext* create_context_internal(const UGContextBuilder* config) {
+    if (!config->headless && !config->window) {
+        fprintf(stderr, "Context requires a window unless headless mode is enabled\n");
+        return NULL;
+    }
+    if (config->headless && (config->headless_width == 0 || config->headless_height == 0)) {
+        fprintf(stderr, "Headless context requires a non-zero size\n");
+        return NULL;
+    }
+
     UGContext* context = (UGContext*)calloc(1, sizeof(UGContext));
     if (!context) {
         return NULL;
     }
 
-    context->window = window;
-    context->surface_format = surface_format;
-    context->present_mode = present_mode;
+    context->window = config->window;
+    atomic_init(&context->redraw_requested, false);
+    atomic_init(&context->redraw_deadline_ns, 0);
+    atomic_init(&context->animating, false);
+    context->surface_format = config->surface_format;
+    context->depth_format = config->depth_format;
+    // Core WebGPU only guarantees 1 and 4 samples
+    context->sample_count = config->sample_count > 1 ? 4 : 1;
+    if (config->sample_count > 1 && config->sample_count != 4) {
+        fprintf(stderr, "Sample count %u not supported, using 4\n", config->sample_count);
+    }
+    context->present_mode = config->present_mode;
+    context->headless = config->headless;
+    context->offscreen_width = config->headless_width;
+    context->offscreen_height = config->headless_height;
+    context->frame_limit = config->frame_limit;
+    context->frames_in_flight = config->frames_in_flight;
+    if (context->frames_in_flight == 0) {
+        context->frames_in_flight = UG_DEFAULT_FRAMES_IN_FLIGHT;
+    } else if (context->frames_in_flight > UG_MAX_FRAMES_IN_FLIGHT) {
+        context->frames_in_flight = UG_MAX_FRAMES_IN_FLIGHT;
+    }
 
     // Create WebGPU instance
     WGPUInstanceDescriptor instance_desc = {0};
@@ -145,48 +256,74 @@ static UGContext* create_context_internal(UGWindow* window, WGPUPowerPreference
         return NULL;
     }
 
-    // Create surface
-    context->surface = create_surface(context->instance, window);
-    if (!context->surface) {
-        fprintf(stderr, "Failed to create surface\n");
+    // Create surface (headless contexts have nothing to present to)
+    if (!context->headless) {
+        context->surface = create_surface(context->instance, context->window);
+        if (!context->surface) {
+            fprintf(stderr, "Failed to create surface\n");
 #if defined(__APPLE__)
-        fprintf(stderr, "  Platform: macOS (Metal)\n");
+            fprintf(stderr, "  Platform: macOS (Metal)\n");
 #elif defined(_WIN32)
-        fprintf(stderr, "  Platform: Windows\n");
+            fprintf(stderr, "  Platform: Windows\n");
 #else
-        fprintf(stderr, "  Platform: Linux (X11)\n");
-        fprintf(stderr, "  Make sure X11 display is available\n");
+            fprintf(stderr, "  Platform: Linux (X11)\n");
+            fprintf(stderr, "  Make sure X11 display is available\n");
 #endif
-        wgpuInstanceRelease(context->instance);
-        free(context);
-        return NULL;
+            wgpuInstanceRelease(context->instance);
+            free(context);
+            return NULL;
+        }
     }
 
     // Request adapter
+    // Headless runs target build machines that often only have a software
+    // rasterizer, so prefer the fallback adapter and only then take any adapter
     WGPURequestAdapterOptions adapter_opts = {
         .compatibleSurface = context->surface,
-        .powerPreference = power_preference,
-    };
-
-    AdapterUserData adapter_data = {0};
-    WGPURequestAdapterCallbackInfo adapter_callback_info = {
-        .mode = WGPUCallbackMode_AllowSpontaneous,
-        .callback = on_adapter_request_ended,
-        .userdata1 = &adapter_data,
+        .powerPreference = config->power_preference,
+        .forceFallbackAdapter = context->headless,
     };
-    wgpuInstanceRequestAdapter(context->instance, &adapter_opts, adapter_callback_info);
+    context->adapter = request_adapter(context->instance, &adapter_opts);
+    if (!context->adapter && context->headless) {
+        fprintf(stderr, "No fallback adapter available, trying any adapter\n");
+        adapter_opts.forceFallbackAdapter = false;
+        context->adapter = request_adapter(context->instance, &adapter_opts);
+    }
 
-    if (!adapter_data.adapter) {
+    if (!context->adapter) {
         fprintf(stderr, "Failed to get adapter\n");
-        wgpuSurfaceRelease(context->surface);
+        if (context->surface) wgpuSurfaceRelease(context->surface);
         wgpuInstanceRelease(context->instance);
         free(context);
         return NULL;
     }
-    context->adapter = adapter_data.adapter;
+
+    // Timestamp queries are optional; profiling is dropped if the adapter lacks them
+    WGPUFeatureName required_features[2];
+    size_t required_feature_count = 0;
+    bool timestamp_queries = false;
+    if (config->gpu_profiler) {
+        if (wgpuAdapterHasFeature(context->adapter, WGPUFeatureName_TimestampQuery)) {
+            required_features[required_feature_count++] = WGPUFeatureName_TimestampQuery;
+            timestamp_queries = true;
+        } else {
+            fprintf(stderr, "GPU profiler disabled: adapter does not support timestamp queries\n");
+        }
+    }
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    // GPU-driven draw counts; multi-draw-indirect itself needs no feature
+    WGPUFeatureName draw_count_feature = (WGPUFeatureName)WGPUNativeFeature_MultiDrawIndirectCount;
+    if (wgpuAdapterHasFeature(context->adapter, draw_count_feature)) {
+        required_features[required_feature_count++] = draw_count_feature;
+        context->multi_draw_indirect_count = true;
+    }
+#endif
 
     // Request device
-    WGPUDeviceDescriptor device_desc = {0};
+    WGPUDeviceDescriptor device_desc = {
+        .requiredFeatureCount = required_feature_count,
+        .requiredFeatures = required_features,
+    };
     DeviceUserData device_data = {0};
     WGPURequestDeviceCallbackInfo device_callback_info = {
         .mode = WGPUCallbackMode_AllowSpontaneous,
@@ -198,7 +335,7 @@ static UGContext* create_context_internal(UGWindow* window, WGPUPowerPreference
     if (!device_data.device) {
         fprintf(stderr, "Failed to get device\n");
         wgpuAdapterRelease(context->adapter);
-        wgpuSurfaceRelease(context->surface);
+        if (context->surface) wgpuSurfaceRelease(context->surface);
         wgpuInstanceRelease(context->instance);
         free(context);
         return NULL;
@@ -208,29 +345,79 @@ static UGContext* create_context_internal(UGWindow* window, WGPUPowerPreference
     // Get queue
     context->queue = wgpuDeviceGetQueue(context->device);
 
+    context->frame_ring = ug_frame_ring_create(context, context->frames_in_flight);
+    context->frame_stats = ug_frame_stats_create();
+    context->job_system = ug_job_system_create(config->worker_count);
+    context->quad_index_buffer = ug_index_buffer_create_quads(context, UG_QUAD_INDEX_MAX_QUADS);
+    if (!context->frame_ring || !context->frame_stats || !context->job_system || !context->quad_index_buffer) {
+        fprintf(stderr, "Failed to allocate frame slots and shared buffers\n");
+        ug_context_destroy(context);
+        return NULL;
+    }
+
+    if (config->replay_input_path) {
+        context->input_log = ug_input_log_open_replay(config->replay_input_path, context->window);
+    } else if (config->record_input_path) {
+        context->input_log = ug_input_log_open_record(config->record_input_path, context->window);
+    }
+    if ((config->replay_input_path || config->record_input_path) && !context->input_log) {
+        ug_context_destroy(context);
+        return NULL;
+    }
+    ug_window_set_input_log(context->window, context->input_log);
+
+    if (timestamp_queries) {
+        context->gpu_profiler = ug_gpu_profiler_create(context, context->frames_in_flight);
+        if (!context->gpu_profiler) {
+            fprintf(stderr, "GPU profiler disabled: failed to create query resources\n");
+        }
+    }
+
+    if (context->headless) {
+        context->offscreen_texture = create_offscreen_texture(context->device, context->surface_format,
+                                                              context->offscreen_width,
+                                                              context->offscreen_height);
+        if (!context->offscreen_texture) {
+            fprintf(stderr, "Failed to create offscreen render target\n");
+            ug_context_destroy(context);
+            return NULL;
+        }
+        context->offscreen_view = wgpuTextureCreateView(context->offscreen_texture, NULL);
+        context->target_width = context->offscreen_width;
+        context->target_height = context->offscreen_height;
+        return context;
+    }
+
     // Configure surface
     int width, height;
-    ug_window_get_size(window, &width, &height);
+    ug_window_get_size(context->window, &width, &height);
 
-    WGPUSurfaceConfiguration config = {
+    WGPUSurfaceConfiguration config_desc = {
         .device = context->device,
-        .format = surface_format,
+        .format = context->surface_format,
         .usage = WGPUTextureUsage_RenderAttachment,
         .width = (uint32_t)width,
         .height = (uint32_t)height,
-        .presentMode = present_mode,
+        .presentMode = context->present_mode,
     };
-    wgpuSurfaceConfigure(context->surface, &config);
+    wgpuSurfaceConfigure(context->surface, &config_desc);
+    context->target_width = (uint32_t)width;
+    context->target_height = (uint32_t)height;
 
     return context;
 }
 
 // Simple context creation with defaults
 UGContext* ug_context_create(UGWindow* window) {
-    return create_context_internal(window,
-                                   WGPUPowerPreference_HighPerformance,
-                                   WGPUPresentMode_Fifo,
-                                   WGPUTextureFormat_BGRA8Unorm);
+    UGContextBuilder defaults = {
+        .window = window,
+        .power_preference = WGPUPowerPreference_HighPerformance,
+        .present_mode = WGPUPresentMode_Fifo,
+        .surface_format = WGPUTextureFormat_BGRA8Unorm,
+        .depth_format = WGPUTextureFormat_Depth24Plus,
+        .worker_count = UG_JOB_WORKERS_AUTO,
+    };
+    return create_context_internal(&defaults);
 }
 
 // Builder pattern implementation
@@ -245,6 +432,9 @@ UGContextBuilder* ug_context_builder_create(UGWindow* window) {
     builder->power_preference = WGPUPowerPreference_HighPerformance;
     builder->present_mode = WGPUPresentMode_Fifo;
     builder->surface_format = WGPUTextureFormat_BGRA8Unorm;
+    builder->depth_format = WGPUTextureFormat_Depth24Plus;
+    builder->frames_in_flight = UG_DEFAULT_FRAMES_IN_FLIGHT;
+    builder->worker_count = UG_JOB_WORKERS_AUTO;
 
     return builder;
 }
@@ -267,15 +457,68 @@ void ug_context_builder_set_surface_format(UGContextBuilder* builder, WGPUTextur
     }
 }
 
+void ug_context_builder_set_depth_format(UGContextBuilder* builder, WGPUTextureFormat format) {
+    if (builder) {
+        builder->depth_format = format;
+    }
+}
+
+void ug_context_builder_set_sample_count(UGContextBuilder* builder, uint32_t sample_count) {
+    if (builder) {
+        builder->sample_count = sample_count;
+    }
+}
+
+void ug_context_builder_set_headless(UGContextBuilder* builder, uint32_t width, uint32_t height) {
+    if (builder) {
+        builder->headless = true;
+        builder->headless_width = width;
+        builder->headless_height = height;
+    }
+}
+
+void ug_context_builder_set_frame_limit(UGContextBuilder* builder, uint64_t frame_count) {
+    if (builder) {
+        builder->frame_limit = frame_count;
+    }
+}
+
+void ug_context_builder_set_frames_in_flight(UGContextBuilder* builder, uint32_t count) {
+    if (builder) {
+        builder->frames_in_flight = count;
+    }
+}
+
+void ug_context_builder_enable_gpu_profiler(UGContextBuilder* builder, bool enable) {
+    if (builder) {
+        builder->gpu_profiler = enable;
+    }
+}
+
+void ug_context_builder_set_worker_count(UGContextBuilder* builder, uint32_t count) {
+    if (builder) {
+        builder->worker_count = count;
+    }
+}
+
+void ug_context_builder_record_input(UGContextBuilder* builder, const char* path) {
+    if (builder) {
+        builder->record_input_path = path;
+    }
+}
+
+void ug_context_builder_replay_input(UGContextBuilder* builder, const char* path) {
+    if (builder) {
+        builder->replay_input_path = path;
+    }
+}
+
 UGContext* ug_context_builder_build(UGContextBuilder* builder) {
     if (!builder) {
         return NULL;
     }
 
-    return create_context_internal(builder->window,
-                                   builder->power_preference,
-                                   builder->present_mode,
-                                   builder->surface_format);
+    return create_context_internal(builder);
 }
 
 void ug_context_builder_destroy(UGContextBuilder* builder) {
@@ -307,6 +550,12 @@ WGPUTextureFormat ug_context_get_surface_format(UGContext* context) {
 
 void ug_context_get_surface_size(UGContext* context, uint32_t* width, uint32_t* height) {
     if (context && width && height) {
+        if (context->headless) {
+            *width = context->offscreen_width;
+            *height = context->offscreen_height;
+            return;
+        }
+
         int w, h;
         ug_window_get_size(context->window, &w, &h);
         *width = (uint32_t)w;
@@ -314,9 +563,238 @@ void ug_context_get_surface_size(UGContext* context, uint32_t* width, uint32_t*
     }
 }
 
+bool ug_context_is_headless(UGContext* context) {
+    return context ? context->headless : false;
+}
+
+WGPUTexture ug_context_get_offscreen_texture(UGContext* context) {
+    return context ? context->offscreen_texture : NULL;
+}
+
+uint64_t ug_context_get_frame_limit(UGContext* context) {
+    return context ? context->frame_limit : 0;
+}
+
+uint32_t ug_context_get_frames_in_flight(UGContext* context) {
+    return context ? context->frames_in_flight : 0;
+}
+
+UGJobSystem* ug_context_get_job_system(UGContext* context) {
+    return context ? context->job_system : NULL;
+}
+
+UGIndexBuffer* ug_context_get_quad_index_buffer(UGContext* context) {
+    return context ? context->quad_index_buffer : NULL;
+}
+
+bool ug_context_supports_multi_draw_indirect_count(UGContext* context) {
+    return context ? context->multi_draw_indirect_count : false;
+}
+
+WGPUTextureFormat ug_context_get_depth_format(UGContext* context) {
+    return context ? context->depth_format : WGPUTextureFormat_Undefined;
+}
+
+uint32_t ug_context_get_sample_count(UGContext* context) {
+    return context ? context->sample_count : 1;
+}
+
+void ug_context_set_target_size(UGContext* context, uint32_t width, uint32_t height) {
+    if (context) {
+        context->target_width = width;
+        context->target_height = height;
+    }
+}
+
+// Return the target's view, (re)creating the texture if the frame texture's size
+// changed. Sized from the texture rather than the window, as the two differ
+// until the surface is reconfigured
+static WGPUTextureView update_surface_target(UGContext* context, SurfaceTarget* target,
+                                             WGPUTextureFormat format, const char* label) {
+    uint32_t width = context->target_width;
+    uint32_t height = context->target_height;
+    if (width == 0 || height == 0) {
+        return NULL;
+    }
+    if (target->view && width == target->width && height == target->height) {
+        return target->view;
+    }
+
+    // Frames still in flight keep their own reference to the old texture
+    if (target->view) wgpuTextureViewRelease(target->view);
+    if (target->texture) wgpuTextureRelease(target->texture);
+    target->view = NULL;
+
+    WGPUTextureDescriptor texture_desc = {
+        .label = {label, WGPU_STRLEN},
+        .size = {width, height, 1},
+        .format = format,
+        .usage = WGPUTextureUsage_RenderAttachment,
+        .dimension = WGPUTextureDimension_2D,
+        .mipLevelCount = 1,
+        .sampleCount = context->sample_count,
+    };
+    target->texture = wgpuDeviceCreateTexture(context->device, &texture_desc);
+    if (!target->texture) {
+        fprintf(stderr, "Failed to create %s\n", label);
+        return NULL;
+    }
+    target->view = wgpuTextureCreateView(target->texture, NULL);
+    target->width = width;
+    target->height = height;
+    return target->view;
+}
+
+static void release_surface_target(SurfaceTarget* target) {
+    if (target->view) wgpuTextureViewRelease(target->view);
+    if (target->texture) wgpuTextureRelease(target->texture);
+}
+
+WGPUTextureView ug_context_get_depth_view(UGContext* context) {
+    if (!context) {
+        return NULL;
+    }
+
+    return update_surface_target(context, &context->depth_target, context->depth_format, "depth buffer");
+}
+
+WGPUTextureView ug_context_get_msaa_view(UGContext* context) {
+    if (!context || context->sample_count == 1) {
+        return NULL;
+    }
+
+    return update_surface_target(context, &context->msaa_target, context->surface_format,
+                                 "multisampled color target");
+}
+
+UGInputLog* ug_context_get_input_log(UGContext* context) {
+    return context ? context->input_log : NULL;
+}
+
+void ug_request_redraw(UGContext* context) {
+    if (!context) {
+        return;
+    }
+    atomic_store(&context->redraw_requested, true);
+    ug_window_wake();
+}
+
+void ug_request_redraw_after(UGContext* context, double seconds) {
+    if (!context) {
+        return;
+    }
+
+    // Keep the earliest pending deadline
+    uint64_t deadline = ug_get_time_ns() + (uint64_t)(seconds > 0.0 ? seconds * 1e9 : 0.0);
+    uint64_t current = atomic_load(&context->redraw_deadline_ns);
+    while ((current == 0 || deadline < current) &&
+           !atomic_compare_exchange_weak(&context->redraw_deadline_ns, &current, deadline)) {
+    }
+    ug_window_wake();
+}
+
+void ug_set_animating(UGContext* context, bool animating) {
+    if (!context) {
+        return;
+    }
+    atomic_store(&context->animating, animating);
+    if (animating) {
+        ug_window_wake();
+    }
+}
+
+bool ug_context_take_redraw_request(UGContext* context, uint64_t now_ns, uint64_t* out_next_deadline_ns) {
+    bool redraw = atomic_exchange(&context->redraw_requested, false);
+
+    uint64_t deadline = atomic_load(&context->redraw_deadline_ns);
+    if (deadline != 0 && deadline <= now_ns &&
+        atomic_compare_exchange_strong(&context->redraw_deadline_ns, &deadline, 0)) {
+        redraw = true;
+        deadline = atomic_load(&context->redraw_deadline_ns);
+    }
+    if (out_next_deadline_ns) {
+        *out_next_deadline_ns = deadline;
+    }
+    return redraw || atomic_load(&context->animating);
+}
+
+WGPUInstance ug_context_get_instance(UGContext* context) {
+    return context ? context->instance : NULL;
+}
+
+WGPUTextureView ug_context_get_offscreen_view(UGContext* context) {
+    return context ? context->offscreen_view : NULL;
+}
+
+UGFrameRing* ug_context_get_frame_ring(UGContext* context) {
+    return context ? context->frame_ring : NULL;
+}
+
+UGGpuProfiler* ug_context_get_gpu_profiler(UGContext* context) {
+    return context ? context->gpu_profiler : NULL;
+}
+
+UGFrameStatsWindow* ug_context_get_frame_stats_window(UGContext* context) {
+    return context ? context->frame_stats : NULL;
+}
+
+void ug_context_poll(UGContext* context, bool wait) {
+    if (!context) {
+        return;
+    }
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    wgpuDevicePoll(context->device, wait, NULL);
+#else
+    (void)wait;
+    wgpuInstanceProcessEvents(context->instance);
+#endif
+}
+
+// Queue work-done callback used by ug_context_wait_idle
+static void on_queue_work_done(WGPUQueueWorkDoneStatus status, void* userdata1, void* userdata2) {
+    (void)status;
+    (void)userdata2;
+    *(bool*)userdata1 = true;
+}
+
+void ug_context_wait_idle(UGContext* context) {
+    if (!context || !context->queue) {
+        return;
+    }
+
+    bool done = false;
+    WGPUQueueWorkDoneCallbackInfo callback_info = {
+        .mode = WGPUCallbackMode_AllowSpontaneous,
+        .callback = on_queue_work_done,
+        .userdata1 = &done,
+    };
+    wgpuQueueOnSubmittedWorkDone(context->queue, callback_info);
+
+    while (!done) {
+        ug_context_poll(context, true);
+    }
+}
+
 // Context cleanup
 void ug_context_destroy(UGContext* context) {
     if (context) {
+        // Frame slots may still be referenced by pending fence callbacks
+        if (context->frame_ring) {
+            ug_context_wait_idle(context);
+        }
+        ug_gpu_profiler_destroy(context->gpu_profiler);
+        ug_frame_ring_destroy(context->frame_ring);
+        ug_frame_stats_destroy(context->frame_stats);
+        ug_job_system_destroy(context->job_system);
+        ug_index_buffer_destroy(context->quad_index_buffer);
+        if (context->input_log) {
+            ug_window_set_input_log(context->window, NULL);
+            ug_input_log_close(context->input_log);
+        }
+        release_surface_target(&context->depth_target);
+        release_surface_target(&context->msaa_target);
+        if (context->offscreen_view) wgpuTextureViewRelease(context->offscreen_view);
+        if (context->offscreen_texture) wgpuTextureRelease(context->offscreen_texture);
         if (context->queue) wgpuQueueRelease(context->queue);
         if (context->device) wgpuDeviceRelease(context->device);
         if (context->adapter) wgpuAdapterRelease(context->adapter);
@@ -0,0 +1,200 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Sort entry: the packet's key and its position in submission order
+typedef struct {
+    uint64_t key;
+    uint32_t index;
+} UGDrawSortEntry;
+
+// Packets collected during the frame, sorted and replayed on submit
+// Storage grows as needed and is kept across frames
+struct UGDrawQueue {
+    UGDrawPacket* packets;
+    UGDrawSortEntry* entries;
+    UGDrawSortEntry* scratch;       // Radix sort ping-pong buffer
+    size_t count;
+    size_t capacity;
+};
+
+UGDrawQueue* ug_draw_queue_create(size_t initial_capacity) {
+    UGDrawQueue* queue = (UGDrawQueue*)calloc(1, sizeof(UGDrawQueue));
+    if (!queue) {
+        return NULL;
+    }
+
+    if (initial_capacity > 0 && !ug_draw_queue_reserve(queue, initial_capacity)) {
+        free(queue);
+        return NULL;
+    }
+
+    return queue;
+}
+
+void ug_draw_queue_destroy(UGDrawQueue* queue) {
+    if (queue) {
+        free(queue->packets);
+        free(queue->entries);
+        free(queue->scratch);
+        free(queue);
+    }
+}
+
+bool ug_draw_queue_reserve(UGDrawQueue* queue, size_t capacity) {
+    if (!queue) {
+        return false;
+    }
+    if (capacity <= queue->capacity) {
+        return true;
+    }
+
+    UGDrawPacket* packets = (UGDrawPacket*)realloc(queue->packets, capacity * sizeof(UGDrawPacket));
+    if (!packets) {
+        return false;
+    }
+    queue->packets = packets;
+
+    // Sort entries are rebuilt on every submit, so their contents need no copying
+    UGDrawSortEntry* entries = (UGDrawSortEntry*)malloc(capacity * sizeof(UGDrawSortEntry));
+    UGDrawSortEntry* scratch = (UGDrawSortEntry*)malloc(capacity * sizeof(UGDrawSortEntry));
+    if (!entries || !scratch) {
+        free(entries);
+        free(scratch);
+        return false;
+    }
+    free(queue->entries);
+    free(queue->scratch);
+    queue->entries = entries;
+    queue->scratch = scratch;
+    queue->capacity = capacity;
+    return true;
+}
+
+bool ug_draw_queue_push(UGDrawQueue* queue, const UGDrawPacket* packet) {
+    if (!queue || !packet || packet->count == 0) {
+        return false;
+    }
+
+    if (queue->count == queue->capacity) {
+        size_t capacity = queue->capacity ? queue->capacity * 2 : 256;
+        if (!ug_draw_queue_reserve(queue, capacity)) {
+            fprintf(stderr, "Failed to grow draw queue to %zu packets\n", capacity);
+            return false;
+        }
+    }
+
+    queue->packets[queue->count++] = *packet;
+    return true;
+}
+
+size_t ug_draw_queue_get_count(UGDrawQueue* queue) {
+    return queue ? queue->count : 0;
+}
+
+void ug_draw_queue_clear(UGDrawQueue* queue) {
+    if (queue) {
+        queue->count = 0;
+    }
+}
+
+uint64_t ug_draw_key(uint8_t layer, bool translucent, uint16_t pipeline_id, uint16_t material_id, float depth) {
+    if (!(depth > 0.0f)) depth = 0.0f;     // Also catches NaN
+    if (depth > 1.0f) depth = 1.0f;
+    uint64_t depth_bits = (uint64_t)(depth * (float)0xFFFFFF);
+
+    uint64_t key = (uint64_t)layer << 56;
+    if (translucent) {
+        // Back to front: depth outranks state, far (1.0) sorting first
+        key |= (uint64_t)1 << 55;
+        key |= (0xFFFFFF - depth_bits) << 31;
+        key |= (uint64_t)(pipeline_id & 0xFFF) << 19;
+        key |= (uint64_t)(material_id & 0xFFFF) << 3;
+    } else {
+        // State first to minimise switches, then front to back for early depth rejection
+        key |= (uint64_t)(pipeline_id & 0xFFF) << 43;
+        key |= (uint64_t)(material_id & 0xFFFF) << 27;
+        key |= depth_bits << 3;
+    }
+    return key;
+}
+
+// LSD radix sort on 8-bit digits; stable, so equal keys keep submission order.
+// Digits that are the same across every key are skipped
+static UGDrawSortEntry* radix_sort(UGDrawSortEntry* entries, UGDrawSortEntry* scratch, size_t count) {
+    uint32_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = entries[i].key;
+        for (int digit = 0; digit < 8; digit++) {
+            histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    UGDrawSortEntry* src = entries;
+    UGDrawSortEntry* dst = scratch;
+    for (int digit = 0; digit < 8; digit++) {
+        uint32_t* histogram = histograms[digit];
+        if (histogram[(src[0].key >> (digit * 8)) & 0xFF] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            uint32_t bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[histogram[(src[i].key >> (digit * 8)) & 0xFF]++] = src[i];
+        }
+
+        UGDrawSortEntry* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    return src;
+}
+
+void ug_draw_queue_submit(UGDrawQueue* queue, UGRenderPass* pass) {
+    if (!queue || !pass || queue->count == 0) {
+        ug_draw_queue_clear(queue);
+        return;
+    }
+
+    UG_PROFILE_BEGIN("ug_draw_queue_submit");
+    for (size_t i = 0; i < queue->count; i++) {
+        queue->entries[i].key = queue->packets[i].sort_key;
+        queue->entries[i].index = (uint32_t)i;
+    }
+    UGDrawSortEntry* sorted = radix_sort(queue->entries, queue->scratch, queue->count);
+
+    // The pass drops state that is already bound and merges contiguous draws,
+    // so replaying in key order is all it takes to batch
+    for (size_t i = 0; i < queue->count; i++) {
+        const UGDrawPacket* packet = &queue->packets[sorted[i].index];
+        ug_render_pass_set_pipeline_topology(pass, packet->pipeline, packet->topology);
+        for (uint32_t group = 0; group < UG_DRAW_PACKET_BIND_GROUPS; group++) {
+            ug_render_pass_set_bind_group(pass, group, packet->bind_groups[group]);
+        }
+        for (uint32_t slot = 0; slot < UG_DRAW_PACKET_VERTEX_BUFFERS; slot++) {
+            ug_render_pass_set_vertex_buffer_slot(pass, slot, packet->vertex_buffers[slot],
+                                                  packet->vertex_offsets[slot]);
+        }
+
+        uint32_t instance_count = packet->instance_count ? packet->instance_count : 1;
+        if (packet->index_buffer) {
+            ug_render_pass_set_index_buffer(pass, packet->index_buffer, 0);
+            ug_render_pass_draw_indexed_instanced(pass, packet->count, instance_count, packet->first,
+                                                  packet->base_vertex, packet->first_instance);
+        } else {
+            ug_render_pass_draw_instanced(pass, packet->count, instance_count, packet->first,
+                                          packet->first_instance);
+        }
+    }
+    UG_PROFILE_END();
+
+    queue->count = 0;
+}
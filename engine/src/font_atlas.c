@@ -1,4 +1,5 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
 #include <stdlib.h>
 #include <string.h>
@@ -56,6 +57,7 @@ struct UGFontAtlas {
     WGPUSampler sampler;
     WGPUBindGroup bind_group;
     WGPURenderPipeline pipeline;
+    WGPURenderPipeline depth_pipeline;  // Same, for passes with the context's depth buffer
     
     int atlas_width;
     int atlas_height;
@@ -76,8 +78,30 @@ typedef struct {
     float color[4];
 } TextVertex;
 
-UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path, 
-                                   int font_size, int atlas_width, int atlas_height) {
+typedef struct {
+    const UGFontAtlas* atlas;
+    unsigned char* bitmap;
+} GlyphRasterJob;
+
+static void rasterize_glyphs(uint32_t begin, uint32_t end, void* data) {
+    GlyphRasterJob* job = (GlyphRasterJob*)data;
+    const UGFontAtlas* atlas = job->atlas;
+
+    for (uint32_t i = begin; i < end; i++) {
+        const GlyphInfo* glyph = &atlas->glyphs[i];
+        int x = (int)glyph->x0;
+        int y = (int)glyph->y0;
+        stbtt_MakeCodepointBitmap(&atlas->font_info,
+                                  job->bitmap + x + y * atlas->atlas_width,
+                                  (int)(glyph->x1 - glyph->x0), (int)(glyph->y1 - glyph->y0),
+                                  atlas->atlas_width,
+                                  atlas->scale, atlas->scale,
+                                  glyph->codepoint);
+    }
+}
+
+static UGFontAtlas* font_atlas_create(UGContext* context, const char* font_path,
+                                      int font_size, int atlas_width, int atlas_height) {
     if (!context || !font_path || font_size <= 0 || atlas_width <= 0 || atlas_height <= 0) {
         return NULL;
     }
@@ -127,6 +151,7 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
     // Pack glyphs into atlas
     int x = 2, y = 2;  // Start with padding
     int row_height = 0;
+    int placed_count = 0;
     
     for (int i = 0; i < num_chars; i++) {
         int codepoint = first_char + i;
@@ -154,14 +179,6 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
             break;
         }
 
-        // Render glyph to bitmap
-        stbtt_MakeCodepointBitmap(&atlas->font_info,
-                                  bitmap + x + y * atlas_width,
-                                  glyph_width, glyph_height,
-                                  atlas_width,
-                                  atlas->scale, atlas->scale,
-                                  codepoint);
-
         // Store glyph info
         atlas->glyphs[i].codepoint = codepoint;
         atlas->glyphs[i].x0 = (float)x;
@@ -177,8 +194,13 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
         if (glyph_height > row_height) {
             row_height = glyph_height;
         }
+        placed_count++;
     }
 
+    // Placed glyphs own disjoint atlas regions, so they rasterize in parallel
+    GlyphRasterJob raster = {atlas, bitmap};
+    ug_parallel_for(ug_context_get_job_system(context), (uint32_t)placed_count, 8, rasterize_glyphs, &raster);
+
     // Create texture
     WGPUTextureDescriptor texture_desc = {
         .size = {atlas_width, atlas_height, 1},
@@ -207,6 +229,9 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
     WGPUExtent3D write_size = {atlas_width, atlas_height, 1};
     wgpuQueueWriteTexture(atlas->queue, &dest, bitmap, atlas_width * atlas_height, &data_layout, &write_size);
 
+    UGFrameCounters* counters = ug_context_get_frame_counters(context);
+    if (counters) counters->upload_bytes += (uint64_t)atlas_width * atlas_height;
+
     free(bitmap);
 
     // Create texture view
@@ -351,7 +376,7 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
             .topology = WGPUPrimitiveTopology_TriangleList,
         },
         .multisample = {
-            .count = 1,
+            .count = ug_context_get_sample_count(context),
             .mask = ~0u,
             .alphaToCoverageEnabled = false,
         },
@@ -360,6 +385,21 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
 
     atlas->pipeline = wgpuDeviceCreateRenderPipeline(atlas->device, &pipeline_desc);
 
+    // Text is an overlay: drawn over whatever is there, leaving depth untouched
+    WGPUDepthStencilState depth_stencil = {
+        .format = ug_context_get_depth_format(context),
+        .depthWriteEnabled = WGPUOptionalBool_False,
+        .depthCompare = WGPUCompareFunction_Always,
+        .stencilFront = {WGPUCompareFunction_Always, WGPUStencilOperation_Keep,
+                         WGPUStencilOperation_Keep, WGPUStencilOperation_Keep},
+        .stencilBack = {WGPUCompareFunction_Always, WGPUStencilOperation_Keep,
+                        WGPUStencilOperation_Keep, WGPUStencilOperation_Keep},
+        .stencilReadMask = ~0u,
+        .stencilWriteMask = ~0u,
+    };
+    pipeline_desc.depthStencil = &depth_stencil;
+    atlas->depth_pipeline = wgpuDeviceCreateRenderPipeline(atlas->device, &pipeline_desc);
+
     // Cleanup temporary resources
     wgpuShaderModuleRelease(shader);
     wgpuBindGroupLayoutRelease(bind_group_layout);
@@ -368,12 +408,21 @@ UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path,
     return atlas;
 }
 
+UGFontAtlas* ug_font_atlas_create(UGContext* context, const char* font_path, 
+                                   int font_size, int atlas_width, int atlas_height) {
+    UG_PROFILE_BEGIN("ug_font_atlas_create");
+    UGFontAtlas* atlas = font_atlas_create(context, font_path, font_size, atlas_width, atlas_height);
+    UG_PROFILE_END();
+    return atlas;
+}
+
 void ug_font_atlas_destroy(UGFontAtlas* atlas) {
     if (!atlas) {
         return;
     }
 
     if (atlas->pipeline) wgpuRenderPipelineRelease(atlas->pipeline);
+    if (atlas->depth_pipeline) wgpuRenderPipelineRelease(atlas->depth_pipeline);
     if (atlas->bind_group) wgpuBindGroupRelease(atlas->bind_group);
     if (atlas->sampler) wgpuSamplerRelease(atlas->sampler);
     if (atlas->texture_view) wgpuTextureViewRelease(atlas->texture_view);
@@ -388,6 +437,10 @@ WGPURenderPipeline ug_font_atlas_get_pipeline(UGFontAtlas* atlas) {
     return atlas ? atlas->pipeline : NULL;
 }
 
+WGPURenderPipeline ug_font_atlas_get_depth_pipeline(UGFontAtlas* atlas) {
+    return atlas ? atlas->depth_pipeline : NULL;
+}
+
 WGPUBindGroup ug_font_atlas_get_bind_group(UGFontAtlas* atlas) {
     return atlas ? atlas->bind_group : NULL;
 }
@@ -402,6 +455,24 @@ static GlyphInfo* find_glyph(UGFontAtlas* atlas, int codepoint) {
     return NULL;
 }
 
+// Convert pixel coordinates to NDC for the _px variants
+static bool px_to_ndc(UGContext* context, float* x, float* y, float* pixel_height) {
+    // Get target dimensions for pixel-to-NDC conversion (works for headless contexts too)
+    uint32_t width, height;
+    ug_context_get_surface_size(context, &width, &height);
+    if (width == 0 || height == 0) {
+        return false;
+    }
+
+    // Origin at top-left, y-down -> NDC with origin at center, y-up
+    *x = (*x / width) * 2.0f - 1.0f;
+    *y = 1.0f - (*y / height) * 2.0f;
+
+    // Calculate pixel height in NDC space
+    *pixel_height = 2.0f / height;
+    return true;
+}
+
 void ug_font_atlas_add_text_px(UGFontAtlas* atlas, void* vertices, size_t* count,
                                const char* text, float x, float y, UGContext* context,
                                float r, float g, float b, float a) {
@@ -409,30 +480,30 @@ void ug_font_atlas_add_text_px(UGFontAtlas* atlas, void* vertices, size_t* count
         return;
     }
 
-    // Get window dimensions for pixel-to-NDC conversion
-    int width, height;
-    ug_window_get_size(ug_context_get_window(context), &width, &height);
-
-    // Convert pixel coordinates to NDC
-    // Origin at top-left, y-down -> NDC with origin at center, y-up
-    float ndc_x = (x / width) * 2.0f - 1.0f;
-    float ndc_y = 1.0f - (y / height) * 2.0f;
-
-    // Calculate pixel height in NDC space
-    float pixel_height = 2.0f / height;
-
-    // Call the NDC-based function
-    ug_font_atlas_add_text(atlas, vertices, count, text, ndc_x, ndc_y, pixel_height, r, g, b, a);
+    float pixel_height;
+    if (px_to_ndc(context, &x, &y, &pixel_height)) {
+        ug_font_atlas_add_text(atlas, vertices, count, text, x, y, pixel_height, r, g, b, a);
+    }
 }
 
-void ug_font_atlas_add_text(UGFontAtlas* atlas, void* vertices, size_t* count,
-                            const char* text, float x, float y, float pixel_height,
-                            float r, float g, float b, float a) {
-    if (!atlas || !vertices || !count || !text) {
+void ug_font_atlas_add_text_px_indexed(UGFontAtlas* atlas, void* vertices, size_t* count,
+                                       const char* text, float x, float y, UGContext* context,
+                                       float r, float g, float b, float a) {
+    if (!atlas || !vertices || !count || !text || !context) {
         return;
     }
 
-    TextVertex* verts = (TextVertex*)vertices;
+    float pixel_height;
+    if (px_to_ndc(context, &x, &y, &pixel_height)) {
+        ug_font_atlas_add_text_indexed(atlas, vertices, count, text, x, y, pixel_height, r, g, b, a);
+    }
+}
+
+// Lay out text as one quad per glyph: 6 vertices (two triangles) or, for
+// indexed drawing, the 4 corners in the order the quad index buffer expects
+static void emit_text(UGFontAtlas* atlas, TextVertex* verts, size_t* count,
+                      const char* text, float x, float y, float pixel_height,
+                      float r, float g, float b, float a, bool indexed) {
     float cursor_x = x;
     float cursor_y = y;
 
@@ -463,28 +534,53 @@ void ug_font_atlas_add_text(UGFontAtlas* atlas, void* vertices, size_t* count,
         float u1 = glyph->x1 * inv_atlas_width;
         float v1 = glyph->y1 * inv_atlas_height;
 
-        // Add two triangles for the quad
-        // Triangle 1
-        verts[*count] = (TextVertex){{x0, y0}, {u0, v0}, {r, g, b, a}};
-        (*count)++;
-        verts[*count] = (TextVertex){{x1, y0}, {u1, v0}, {r, g, b, a}};
-        (*count)++;
-        verts[*count] = (TextVertex){{x0, y1}, {u0, v1}, {r, g, b, a}};
-        (*count)++;
-
-        // Triangle 2
-        verts[*count] = (TextVertex){{x0, y1}, {u0, v1}, {r, g, b, a}};
-        (*count)++;
-        verts[*count] = (TextVertex){{x1, y0}, {u1, v0}, {r, g, b, a}};
-        (*count)++;
-        verts[*count] = (TextVertex){{x1, y1}, {u1, v1}, {r, g, b, a}};
-        (*count)++;
+        if (indexed) {
+            verts[(*count)++] = (TextVertex){{x0, y0}, {u0, v0}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x1, y0}, {u1, v0}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x0, y1}, {u0, v1}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x1, y1}, {u1, v1}, {r, g, b, a}};
+        } else {
+            // Add two triangles for the quad
+            // Triangle 1
+            verts[(*count)++] = (TextVertex){{x0, y0}, {u0, v0}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x1, y0}, {u1, v0}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x0, y1}, {u0, v1}, {r, g, b, a}};
+
+            // Triangle 2
+            verts[(*count)++] = (TextVertex){{x0, y1}, {u0, v1}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x1, y0}, {u1, v0}, {r, g, b, a}};
+            verts[(*count)++] = (TextVertex){{x1, y1}, {u1, v1}, {r, g, b, a}};
+        }
 
         // Advance cursor (convert pixel advance to NDC)
         cursor_x += glyph->xadvance * pixel_scale;
     }
 }
 
+void ug_font_atlas_add_text(UGFontAtlas* atlas, void* vertices, size_t* count,
+                            const char* text, float x, float y, float pixel_height,
+                            float r, float g, float b, float a) {
+    if (!atlas || !vertices || !count || !text) {
+        return;
+    }
+
+    UG_PROFILE_BEGIN("ug_font_atlas_add_text");
+    emit_text(atlas, (TextVertex*)vertices, count, text, x, y, pixel_height, r, g, b, a, false);
+    UG_PROFILE_END();
+}
+
+void ug_font_atlas_add_text_indexed(UGFontAtlas* atlas, void* vertices, size_t* count,
+                                    const char* text, float x, float y, float pixel_height,
+                                    float r, float g, float b, float a) {
+    if (!atlas || !vertices || !count || !text) {
+        return;
+    }
+
+    UG_PROFILE_BEGIN("ug_font_atlas_add_text");
+    emit_text(atlas, (TextVertex*)vertices, count, text, x, y, pixel_height, r, g, b, a, true);
+    UG_PROFILE_END();
+}
+
 size_t ug_font_atlas_get_vertex_size(void) {
     return sizeof(TextVertex);
 }
@@ -0,0 +1,151 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// Chunk of arena memory; data follows the header
+struct UGArenaChunk {
+    UGArenaChunk* next;
+    size_t capacity;
+    size_t used;
+};
+
+static UGArenaChunk* arena_chunk_create(size_t capacity) {
+    UGArenaChunk* chunk = (UGArenaChunk*)malloc(sizeof(UGArenaChunk) + capacity);
+    if (!chunk) {
+        return NULL;
+    }
+
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+static unsigned char* arena_chunk_data(UGArenaChunk* chunk) {
+    return (unsigned char*)(chunk + 1);
+}
+
+void ug_frame_arena_init(UGFrameArena* arena, size_t chunk_size) {
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->chunk_size = chunk_size ? chunk_size : UG_FRAME_ARENA_DEFAULT_CHUNK_SIZE;
+    arena->window_peak = 0;
+    arena->low_frames = 0;
+}
+
+void* ug_frame_arena_alloc(UGFrameArena* arena, size_t size, size_t align) {
+    if (size == 0) {
+        return NULL;
+    }
+    if (align == 0) {
+        align = UG_FRAME_ALLOC_DEFAULT_ALIGN;
+    }
+    if ((align & (align - 1)) != 0) {
+        return NULL;  // Alignment must be a power of two
+    }
+
+    // Bump within the current chunk, then within any chunk retained from
+    // earlier frames, before growing by a new chunk
+    UGArenaChunk* chunk = arena->current ? arena->current : arena->first;
+    while (chunk) {
+        uintptr_t base = (uintptr_t)arena_chunk_data(chunk);
+        uintptr_t aligned = (base + chunk->used + (align - 1)) & ~(uintptr_t)(align - 1);
+        size_t offset = (size_t)(aligned - base);
+        if (offset + size <= chunk->capacity) {
+            chunk->used = offset + size;
+            arena->current = chunk;
+            return (void*)aligned;
+        }
+        chunk = chunk->next;
+    }
+
+    // Grow: never move or free live memory during the frame
+    size_t capacity = size + align;
+    if (capacity < arena->chunk_size) {
+        capacity = arena->chunk_size;
+    }
+    UGArenaChunk* grown = arena_chunk_create(capacity);
+    if (!grown) {
+        return NULL;
+    }
+
+    if (arena->first) {
+        // Append after the last chunk in the list
+        UGArenaChunk* last = arena->current ? arena->current : arena->first;
+        while (last->next) {
+            last = last->next;
+        }
+        last->next = grown;
+    } else {
+        arena->first = grown;
+    }
+    arena->current = grown;
+
+    uintptr_t base = (uintptr_t)arena_chunk_data(grown);
+    uintptr_t aligned = (base + (align - 1)) & ~(uintptr_t)(align - 1);
+    grown->used = (size_t)(aligned - base) + size;
+    return (void*)aligned;
+}
+
+// Replace every chunk with one empty chunk of the given capacity. Keeps the
+// current chunks if the allocation fails
+static void arena_replace_chunks(UGFrameArena* arena, size_t capacity) {
+    UGArenaChunk* replacement = arena_chunk_create(capacity);
+    if (replacement) {
+        ug_frame_arena_release(arena);
+        arena->first = replacement;
+    }
+    arena->window_peak = 0;
+    arena->low_frames = 0;
+}
+
+void ug_frame_arena_reset(UGFrameArena* arena) {
+    if (!arena->first) {
+        return;
+    }
+
+    size_t used = 0;
+    size_t capacity = 0;
+    for (UGArenaChunk* chunk = arena->first; chunk; chunk = chunk->next) {
+        used += chunk->used;
+        capacity += chunk->capacity;
+    }
+
+    if (arena->first->next) {
+        // A frame that needed several chunks is coalesced into one chunk of the
+        // combined size, so the next frame of the same shape allocates nothing
+        arena_replace_chunks(arena, capacity);
+    } else if (capacity > arena->chunk_size) {
+        // A spike's size is given back once frames stay well below it: after
+        // UG_FRAME_ARENA_SHRINK_FRAMES frames under a quarter full, shrink to
+        // twice the largest of them (never below the chunk size)
+        if (used < capacity / 4) {
+            arena->low_frames++;
+            if (used > arena->window_peak) arena->window_peak = used;
+        } else {
+            arena->low_frames = 0;
+            arena->window_peak = 0;
+        }
+        if (arena->low_frames >= UG_FRAME_ARENA_SHRINK_FRAMES) {
+            size_t target = arena->window_peak * 2;
+            arena_replace_chunks(arena, target > arena->chunk_size ? target : arena->chunk_size);
+        }
+    }
+
+    for (UGArenaChunk* chunk = arena->first; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    arena->current = arena->first;
+}
+
+void ug_frame_arena_release(UGFrameArena* arena) {
+    UGArenaChunk* chunk = arena->first;
+    while (chunk) {
+        UGArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+}
@@ -0,0 +1,141 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Rolling window of per-frame timings and counters, fed by the frame ring
+struct UGFrameStatsWindow {
+    uint64_t samples[UG_FRAME_TIMING_COUNT][UG_FRAME_STATS_WINDOW];  // Nanoseconds
+    uint32_t sample_count[UG_FRAME_TIMING_COUNT];
+    uint32_t sample_next[UG_FRAME_TIMING_COUNT];
+
+    UGFrameCounters current;                        // Frame being recorded
+    UGFrameCounters history[UG_FRAME_STATS_WINDOW];
+    uint32_t history_count;
+    uint32_t history_next;
+
+    uint64_t frames;
+    uint64_t last_frame_begin_ns;
+};
+
+UGFrameStatsWindow* ug_frame_stats_create(void) {
+    return (UGFrameStatsWindow*)calloc(1, sizeof(UGFrameStatsWindow));
+}
+
+void ug_frame_stats_destroy(UGFrameStatsWindow* window) {
+    free(window);
+}
+
+void ug_frame_stats_add_timing(UGFrameStatsWindow* window, UGFrameTiming timing, uint64_t ns) {
+    if (!window || timing >= UG_FRAME_TIMING_COUNT) {
+        return;
+    }
+
+    window->samples[timing][window->sample_next[timing]] = ns;
+    window->sample_next[timing] = (window->sample_next[timing] + 1) % UG_FRAME_STATS_WINDOW;
+    if (window->sample_count[timing] < UG_FRAME_STATS_WINDOW) {
+        window->sample_count[timing]++;
+    }
+}
+
+void ug_frame_stats_begin_frame(UGFrameStatsWindow* window, uint64_t now_ns) {
+    if (!window) {
+        return;
+    }
+
+    // Frame time runs from one frame's begin to the next, so the first frame has none
+    if (window->last_frame_begin_ns) {
+        ug_frame_stats_add_timing(window, UG_FRAME_TIMING_FRAME, now_ns - window->last_frame_begin_ns);
+    }
+    window->last_frame_begin_ns = now_ns;
+}
+
+void ug_frame_stats_end_frame(UGFrameStatsWindow* window) {
+    if (!window) {
+        return;
+    }
+
+    window->history[window->history_next] = window->current;
+    window->history_next = (window->history_next + 1) % UG_FRAME_STATS_WINDOW;
+    if (window->history_count < UG_FRAME_STATS_WINDOW) {
+        window->history_count++;
+    }
+    memset(&window->current, 0, sizeof(window->current));
+    window->frames++;
+}
+
+UGFrameCounters* ug_context_get_frame_counters(UGContext* context) {
+    UGFrameStatsWindow* window = ug_context_get_frame_stats_window(context);
+    return window ? &window->current : NULL;
+}
+
+void ug_frame_counters_add(UGFrameCounters* dst, const UGFrameCounters* src) {
+    if (!dst || !src) {
+        return;
+    }
+
+    dst->draw_calls += src->draw_calls;
+    dst->pipeline_switches += src->pipeline_switches;
+    dst->bind_group_switches += src->bind_group_switches;
+    dst->upload_bytes += src->upload_bytes;
+    dst->redundant_state_calls += src->redundant_state_calls;
+    dst->merged_draws += src->merged_draws;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentiles over one timing's window
+static UGTimingStats compute_timing_stats(const UGFrameStatsWindow* window, UGFrameTiming timing) {
+    UGTimingStats stats = {0};
+    uint32_t count = window->sample_count[timing];
+    if (count == 0) {
+        return stats;
+    }
+
+    uint64_t sorted[UG_FRAME_STATS_WINDOW];
+    memcpy(sorted, window->samples[timing], count * sizeof(uint64_t));
+    qsort(sorted, count, sizeof(uint64_t), compare_u64);
+
+    stats.sample_count = count;
+    stats.p50_ms = (double)sorted[(count - 1) * 50 / 100] * 1e-6;
+    stats.p95_ms = (double)sorted[(count - 1) * 95 / 100] * 1e-6;
+    stats.p99_ms = (double)sorted[(count - 1) * 99 / 100] * 1e-6;
+    stats.max_ms = (double)sorted[count - 1] * 1e-6;
+    return stats;
+}
+
+bool ug_context_get_frame_stats(UGContext* context, UGFrameStats* out_stats) {
+    UGFrameStatsWindow* window = ug_context_get_frame_stats_window(context);
+    if (!window || !out_stats) {
+        return false;
+    }
+
+    memset(out_stats, 0, sizeof(*out_stats));
+    out_stats->frame_time = compute_timing_stats(window, UG_FRAME_TIMING_FRAME);
+    out_stats->cpu_time = compute_timing_stats(window, UG_FRAME_TIMING_CPU);
+    out_stats->acquire_time = compute_timing_stats(window, UG_FRAME_TIMING_ACQUIRE);
+    out_stats->submit_time = compute_timing_stats(window, UG_FRAME_TIMING_SUBMIT);
+    out_stats->present_time = compute_timing_stats(window, UG_FRAME_TIMING_PRESENT);
+    out_stats->frames = window->frames;
+
+    if (window->history_count > 0) {
+        uint32_t last = (window->history_next + UG_FRAME_STATS_WINDOW - 1) % UG_FRAME_STATS_WINDOW;
+        out_stats->last_frame = window->history[last];
+    }
+    for (uint32_t i = 0; i < window->history_count; i++) {
+        const UGFrameCounters* counters = &window->history[i];
+        UGFrameCounters* peak = &out_stats->peak;
+        if (counters->draw_calls > peak->draw_calls) peak->draw_calls = counters->draw_calls;
+        if (counters->pipeline_switches > peak->pipeline_switches) peak->pipeline_switches = counters->pipeline_switches;
+        if (counters->bind_group_switches > peak->bind_group_switches) peak->bind_group_switches = counters->bind_group_switches;
+        if (counters->upload_bytes > peak->upload_bytes) peak->upload_bytes = counters->upload_bytes;
+        if (counters->redundant_state_calls > peak->redundant_state_calls) peak->redundant_state_calls = counters->redundant_state_calls;
+        if (counters->merged_draws > peak->merged_draws) peak->merged_draws = counters->merged_draws;
+    }
+
+    return true;
+}
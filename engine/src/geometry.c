@@ -21,6 +21,20 @@ void ug_add_rect_2d_color(UGVertex2DColor* vertices, size_t* count,
     vertices[(*count)++] = (UGVertex2DColor){{x + w, y + h}, {r, g, b}};
 }
 
+// Add a rectangle as 4 corners for the quad index buffer (2D position + color format)
+void ug_add_rect_2d_color_indexed(UGVertex2DColor* vertices, size_t* count,
+                                  float x, float y, float w, float h,
+                                  float r, float g, float b) {
+    if (!vertices || !count) {
+        return;
+    }
+
+    vertices[(*count)++] = (UGVertex2DColor){{x - w, y - h}, {r, g, b}};
+    vertices[(*count)++] = (UGVertex2DColor){{x + w, y - h}, {r, g, b}};
+    vertices[(*count)++] = (UGVertex2DColor){{x - w, y + h}, {r, g, b}};
+    vertices[(*count)++] = (UGVertex2DColor){{x + w, y + h}, {r, g, b}};
+}
+
 // Add a circle (or ellipse) to a vertex array (2D position + color format)
 void ug_add_circle_2d_color(UGVertex2DColor* vertices, size_t* count,
                             float x, float y, float width, float height,
@@ -62,6 +76,83 @@ void ug_add_circle_2d_color(UGVertex2DColor* vertices, size_t* count,
     }
 }
 
+// Shapes smaller than this are not worth a job each
+#define BULK_MIN_BATCH 64
+
+typedef struct {
+    UGVertex2DColor* vertices;
+    const void* shapes;
+    int segments;
+} BulkShapes;
+
+static void emit_rects(uint32_t begin, uint32_t end, void* data) {
+    BulkShapes* bulk = (BulkShapes*)data;
+    const UGRect2D* rects = (const UGRect2D*)bulk->shapes;
+    size_t count = (size_t)begin * 6;
+    for (uint32_t i = begin; i < end; i++) {
+        const UGRect2D* rect = &rects[i];
+        ug_add_rect_2d_color(bulk->vertices, &count, rect->x, rect->y, rect->w, rect->h,
+                             rect->r, rect->g, rect->b);
+    }
+}
+
+static void emit_rects_indexed(uint32_t begin, uint32_t end, void* data) {
+    BulkShapes* bulk = (BulkShapes*)data;
+    const UGRect2D* rects = (const UGRect2D*)bulk->shapes;
+    size_t count = (size_t)begin * 4;
+    for (uint32_t i = begin; i < end; i++) {
+        const UGRect2D* rect = &rects[i];
+        ug_add_rect_2d_color_indexed(bulk->vertices, &count, rect->x, rect->y, rect->w, rect->h,
+                                     rect->r, rect->g, rect->b);
+    }
+}
+
+void ug_add_rects_2d_color(UGVertex2DColor* vertices, size_t* count,
+                           const UGRect2D* rects, size_t rect_count, UGJobSystem* jobs) {
+    if (!vertices || !count || !rects || rect_count == 0) {
+        return;
+    }
+
+    // Each batch writes at a fixed offset, so no batch depends on another
+    BulkShapes bulk = {vertices + *count, rects, 0};
+    ug_parallel_for(jobs, (uint32_t)rect_count, BULK_MIN_BATCH, emit_rects, &bulk);
+    *count += rect_count * 6;
+}
+
+void ug_add_rects_2d_color_indexed(UGVertex2DColor* vertices, size_t* count,
+                                   const UGRect2D* rects, size_t rect_count, UGJobSystem* jobs) {
+    if (!vertices || !count || !rects || rect_count == 0) {
+        return;
+    }
+
+    BulkShapes bulk = {vertices + *count, rects, 0};
+    ug_parallel_for(jobs, (uint32_t)rect_count, BULK_MIN_BATCH, emit_rects_indexed, &bulk);
+    *count += rect_count * 4;
+}
+
+static void emit_circles(uint32_t begin, uint32_t end, void* data) {
+    BulkShapes* bulk = (BulkShapes*)data;
+    const UGCircle2D* circles = (const UGCircle2D*)bulk->shapes;
+    size_t count = (size_t)begin * 3 * bulk->segments;
+    for (uint32_t i = begin; i < end; i++) {
+        const UGCircle2D* circle = &circles[i];
+        ug_add_circle_2d_color(bulk->vertices, &count, circle->x, circle->y, circle->width, circle->height,
+                               circle->r, circle->g, circle->b, bulk->segments);
+    }
+}
+
+void ug_add_circles_2d_color(UGVertex2DColor* vertices, size_t* count,
+                             const UGCircle2D* circles, size_t circle_count,
+                             int segments, UGJobSystem* jobs) {
+    if (!vertices || !count || !circles || circle_count == 0 || segments < 3) {
+        return;
+    }
+
+    BulkShapes bulk = {vertices + *count, circles, segments};
+    ug_parallel_for(jobs, (uint32_t)circle_count, BULK_MIN_BATCH, emit_circles, &bulk);
+    *count += circle_count * 3 * (size_t)segments;
+}
+
 // Add a rectangle to a vertex array (2D position + UV format)
 void ug_add_rect_2d_textured(UGVertex2DTextured* vertices, size_t* count,
                              float x, float y, float w, float h,
@@ -82,6 +173,20 @@ void ug_add_rect_2d_textured(UGVertex2DTextured* vertices, size_t* count,
     vertices[(*count)++] = (UGVertex2DTextured){{x + w, y + h}, {u1, v1}};
 }
 
+// Add a rectangle as 4 corners for the quad index buffer (2D position + UV format)
+void ug_add_rect_2d_textured_indexed(UGVertex2DTextured* vertices, size_t* count,
+                                     float x, float y, float w, float h,
+                                     float u0, float v0, float u1, float v1) {
+    if (!vertices || !count) {
+        return;
+    }
+
+    vertices[(*count)++] = (UGVertex2DTextured){{x - w, y - h}, {u0, v0}};
+    vertices[(*count)++] = (UGVertex2DTextured){{x + w, y - h}, {u1, v0}};
+    vertices[(*count)++] = (UGVertex2DTextured){{x - w, y + h}, {u0, v1}};
+    vertices[(*count)++] = (UGVertex2DTextured){{x + w, y + h}, {u1, v1}};
+}
+
 // Add a circle (or ellipse) to a vertex array (2D position + UV format)
 void ug_add_circle_2d_textured(UGVertex2DTextured* vertices, size_t* count,
                                float x, float y, float width, float height,
@@ -0,0 +1,276 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Each frame slot owns a fixed range of the query set with a begin/end pair
+// per pass. Timestamps are resolved and copied into the slot's readback buffer
+// at the end of the frame, mapped after submit, and only read once the slot's
+// fence has signalled - so reading results never waits on the GPU.
+
+#define QUERIES_PER_SLOT (UG_GPU_PROFILER_MAX_PASSES * 2)
+#define SLOT_BYTES (QUERIES_PER_SLOT * sizeof(uint64_t))
+
+enum {
+    READBACK_IDLE,
+    READBACK_MAPPING,
+    READBACK_MAPPED,
+};
+
+typedef struct {
+    WGPUBuffer readback;
+    atomic_int state;
+    uint32_t pass_count;     // Passes timed in the frame recorded into this slot
+    uint64_t frame_number;
+    bool active;             // False when the readback was still busy at frame start
+} UGGpuProfilerSlot;
+
+struct UGGpuProfiler {
+    UGContext* context;
+    WGPUQuerySet query_set;
+    WGPUBuffer resolve_buffer;
+    double ms_per_tick;      // Timestamp period, converted to milliseconds
+    UGGpuProfilerSlot slots[UG_MAX_FRAMES_IN_FLIGHT];
+    uint32_t slot_count;
+
+    // Most recently read back frame
+    double pass_ms[UG_GPU_PROFILER_MAX_PASSES];
+    uint32_t pass_count;
+    double frame_ms;
+    uint64_t result_frame;
+};
+
+UGGpuProfiler* ug_gpu_profiler_create(UGContext* context, uint32_t slot_count) {
+    if (!context || slot_count == 0 || slot_count > UG_MAX_FRAMES_IN_FLIGHT) {
+        return NULL;
+    }
+
+    UGGpuProfiler* profiler = (UGGpuProfiler*)calloc(1, sizeof(UGGpuProfiler));
+    if (!profiler) {
+        return NULL;
+    }
+
+    profiler->context = context;
+    profiler->slot_count = slot_count;
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    profiler->ms_per_tick = (double)wgpuQueueGetTimestampPeriod(ug_context_get_queue(context)) * 1e-6;
+#else
+    // No way to query the period through the standard header; assume
+    // nanosecond ticks, as wgpu reports on most backends
+    profiler->ms_per_tick = 1e-6;
+#endif
+    WGPUDevice device = ug_context_get_device(context);
+
+    WGPUQuerySetDescriptor query_set_desc = {
+        .label = {"GPU Profiler Timestamps", WGPU_STRLEN},
+        .type = WGPUQueryType_Timestamp,
+        .count = slot_count * QUERIES_PER_SLOT,
+    };
+    profiler->query_set = wgpuDeviceCreateQuerySet(device, &query_set_desc);
+
+    // Resolve destinations must be 256-byte aligned; each slot's range is a
+    // multiple of that
+    WGPUBufferDescriptor resolve_desc = {
+        .label = {"GPU Profiler Resolve", WGPU_STRLEN},
+        .size = slot_count * SLOT_BYTES,
+        .usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc,
+    };
+    profiler->resolve_buffer = wgpuDeviceCreateBuffer(device, &resolve_desc);
+
+    if (!profiler->query_set || !profiler->resolve_buffer) {
+        fprintf(stderr, "Failed to create GPU profiler query resources\n");
+        ug_gpu_profiler_destroy(profiler);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < slot_count; i++) {
+        UGGpuProfilerSlot* slot = &profiler->slots[i];
+        atomic_init(&slot->state, READBACK_IDLE);
+
+        WGPUBufferDescriptor readback_desc = {
+            .label = {"GPU Profiler Readback", WGPU_STRLEN},
+            .size = SLOT_BYTES,
+            .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+        };
+        slot->readback = wgpuDeviceCreateBuffer(device, &readback_desc);
+        if (!slot->readback) {
+            fprintf(stderr, "Failed to create GPU profiler readback buffer\n");
+            ug_gpu_profiler_destroy(profiler);
+            return NULL;
+        }
+    }
+
+    return profiler;
+}
+
+void ug_gpu_profiler_destroy(UGGpuProfiler* profiler) {
+    if (!profiler) {
+        return;
+    }
+
+    // Map callbacks point at the slots, so let any outstanding one land first
+    for (uint32_t i = 0; i < profiler->slot_count; i++) {
+        UGGpuProfilerSlot* slot = &profiler->slots[i];
+        while (atomic_load(&slot->state) == READBACK_MAPPING) {
+            ug_context_poll(profiler->context, true);
+        }
+        if (atomic_load(&slot->state) == READBACK_MAPPED) {
+            wgpuBufferUnmap(slot->readback);
+        }
+        if (slot->readback) wgpuBufferRelease(slot->readback);
+    }
+
+    if (profiler->resolve_buffer) wgpuBufferRelease(profiler->resolve_buffer);
+    if (profiler->query_set) wgpuQuerySetRelease(profiler->query_set);
+    free(profiler);
+}
+
+// Turn the raw timestamps of a finished frame into the published results
+static void read_slot_results(UGGpuProfiler* profiler, UGGpuProfilerSlot* slot) {
+    const uint64_t* timestamps = (const uint64_t*)wgpuBufferGetConstMappedRange(
+        slot->readback, 0, slot->pass_count * 2 * sizeof(uint64_t));
+    if (!timestamps) {
+        return;
+    }
+
+    // Timestamps are ticks of the queue's timestamp period (ms_per_tick); some
+    // drivers report an end before its begin, which is clamped to zero rather
+    // than wrapping
+    uint64_t first = timestamps[0];
+    uint64_t last = timestamps[0];
+    for (uint32_t i = 0; i < slot->pass_count; i++) {
+        uint64_t begin = timestamps[i * 2];
+        uint64_t end = timestamps[i * 2 + 1];
+        profiler->pass_ms[i] = end > begin ? (double)(end - begin) * profiler->ms_per_tick : 0.0;
+        if (begin < first) first = begin;
+        if (end > last) last = end;
+    }
+
+    profiler->pass_count = slot->pass_count;
+    profiler->frame_ms = (double)(last - first) * profiler->ms_per_tick;
+    profiler->result_frame = slot->frame_number;
+}
+
+void ug_gpu_profiler_begin_frame(UGGpuProfiler* profiler, uint32_t slot_index, uint64_t frame_number) {
+    if (!profiler || slot_index >= profiler->slot_count) {
+        return;
+    }
+
+    UGGpuProfilerSlot* slot = &profiler->slots[slot_index];
+
+    // The slot's fence has signalled, so its map has normally completed too;
+    // give the callback one chance to run before giving up on this frame
+    if (atomic_load(&slot->state) == READBACK_MAPPING) {
+        ug_context_poll(profiler->context, false);
+    }
+
+    int state = atomic_load(&slot->state);
+    if (state == READBACK_MAPPED) {
+        read_slot_results(profiler, slot);
+        wgpuBufferUnmap(slot->readback);
+        atomic_store(&slot->state, READBACK_IDLE);
+        state = READBACK_IDLE;
+    }
+
+    // A buffer that is still being mapped can't be copied into, so the frame
+    // goes untimed rather than stalling
+    slot->active = state == READBACK_IDLE;
+    slot->pass_count = 0;
+    slot->frame_number = frame_number;
+}
+
+bool ug_gpu_profiler_next_pass(UGGpuProfiler* profiler, uint32_t slot_index,
+                               WGPURenderPassTimestampWrites* out_writes) {
+    if (!profiler || slot_index >= profiler->slot_count || !out_writes) {
+        return false;
+    }
+
+    UGGpuProfilerSlot* slot = &profiler->slots[slot_index];
+    if (!slot->active || slot->pass_count >= UG_GPU_PROFILER_MAX_PASSES) {
+        return false;
+    }
+
+    uint32_t base = slot_index * QUERIES_PER_SLOT + slot->pass_count * 2;
+    out_writes->querySet = profiler->query_set;
+    out_writes->beginningOfPassWriteIndex = base;
+    out_writes->endOfPassWriteIndex = base + 1;
+    slot->pass_count++;
+    return true;
+}
+
+void ug_gpu_profiler_resolve(UGGpuProfiler* profiler, uint32_t slot_index, WGPUCommandEncoder encoder) {
+    if (!profiler || slot_index >= profiler->slot_count || !encoder) {
+        return;
+    }
+
+    UGGpuProfilerSlot* slot = &profiler->slots[slot_index];
+    if (!slot->active || slot->pass_count == 0) {
+        return;
+    }
+
+    uint32_t first_query = slot_index * QUERIES_PER_SLOT;
+    uint64_t offset = (uint64_t)first_query * sizeof(uint64_t);
+    uint64_t size = (uint64_t)slot->pass_count * 2 * sizeof(uint64_t);
+    wgpuCommandEncoderResolveQuerySet(encoder, profiler->query_set, first_query,
+                                      slot->pass_count * 2, profiler->resolve_buffer, offset);
+    wgpuCommandEncoderCopyBufferToBuffer(encoder, profiler->resolve_buffer, offset,
+                                         slot->readback, 0, size);
+}
+
+static void on_readback_mapped(WGPUMapAsyncStatus status, WGPUStringView message,
+                               void* userdata1, void* userdata2) {
+    (void)message;
+    (void)userdata2;
+    UGGpuProfilerSlot* slot = (UGGpuProfilerSlot*)userdata1;
+    atomic_store(&slot->state, status == WGPUMapAsyncStatus_Success ? READBACK_MAPPED : READBACK_IDLE);
+}
+
+void ug_gpu_profiler_after_submit(UGGpuProfiler* profiler, uint32_t slot_index) {
+    if (!profiler || slot_index >= profiler->slot_count) {
+        return;
+    }
+
+    UGGpuProfilerSlot* slot = &profiler->slots[slot_index];
+    if (!slot->active || slot->pass_count == 0) {
+        return;
+    }
+
+    atomic_store(&slot->state, READBACK_MAPPING);
+    WGPUBufferMapCallbackInfo map_info = {
+        .mode = WGPUCallbackMode_AllowSpontaneous,
+        .callback = on_readback_mapped,
+        .userdata1 = slot,
+    };
+    wgpuBufferMapAsync(slot->readback, WGPUMapMode_Read, 0,
+                       slot->pass_count * 2 * sizeof(uint64_t), map_info);
+}
+
+// Public queries
+bool ug_profiler_is_enabled(UGContext* context) {
+    return ug_context_get_gpu_profiler(context) != NULL;
+}
+
+uint32_t ug_profiler_get_pass_times(UGContext* context, double* out_ms, uint32_t max_count) {
+    UGGpuProfiler* profiler = ug_context_get_gpu_profiler(context);
+    if (!profiler || !out_ms) {
+        return 0;
+    }
+
+    uint32_t count = profiler->pass_count < max_count ? profiler->pass_count : max_count;
+    for (uint32_t i = 0; i < count; i++) {
+        out_ms[i] = profiler->pass_ms[i];
+    }
+    return count;
+}
+
+double ug_profiler_get_frame_gpu_time(UGContext* context) {
+    UGGpuProfiler* profiler = ug_context_get_gpu_profiler(context);
+    return profiler ? profiler->frame_ms : 0.0;
+}
+
+uint64_t ug_profiler_get_result_frame(UGContext* context) {
+    UGGpuProfiler* profiler = ug_context_get_gpu_profiler(context);
+    return profiler ? profiler->result_frame : 0;
+}
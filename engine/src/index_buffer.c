@@ -0,0 +1,137 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Index buffer for indexed draws, 16 or 32 bits per index
+struct UGIndexBuffer {
+    UGContext* context;
+    WGPUBuffer buffer;
+    WGPUQueue queue;
+    WGPUIndexFormat format;
+    size_t capacity;            // Maximum number of indices
+    size_t index_size;          // 2 or 4 bytes
+    UGBundleLinks bundle_links; // Render bundles recorded against this buffer
+};
+
+// Queue writes must be a multiple of 4 bytes
+#define ALIGN4(size) (((size) + 3) & ~(size_t)3)
+
+UGIndexBuffer* ug_index_buffer_create(UGContext* context, WGPUIndexFormat format, size_t max_indices) {
+    if (!context || max_indices == 0 ||
+        (format != WGPUIndexFormat_Uint16 && format != WGPUIndexFormat_Uint32)) {
+        return NULL;
+    }
+
+    UGIndexBuffer* ib = (UGIndexBuffer*)calloc(1, sizeof(UGIndexBuffer));
+    if (!ib) {
+        return NULL;
+    }
+
+    ib->index_size = format == WGPUIndexFormat_Uint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    WGPUBufferDescriptor buffer_desc = {
+        .size = ALIGN4(ib->index_size * max_indices),
+        .usage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst,
+        .mappedAtCreation = false,
+    };
+
+    ib->context = context;
+    ib->buffer = wgpuDeviceCreateBuffer(ug_context_get_device(context), &buffer_desc);
+    ib->queue = ug_context_get_queue(context);
+    ib->format = format;
+    ib->capacity = max_indices;
+    if (!ib->buffer) {
+        free(ib);
+        return NULL;
+    }
+
+    return ib;
+}
+
+void ug_index_buffer_update(UGIndexBuffer* ib, const void* data, size_t index_count) {
+    if (!ib || !data || index_count == 0) {
+        return;
+    }
+
+    if (index_count > ib->capacity) {
+        index_count = ib->capacity;
+    }
+    size_t data_size = index_count * ib->index_size;
+    size_t aligned_size = data_size & ~(size_t)3;
+
+    UG_PROFILE_BEGIN("ug_index_buffer_update");
+    if (aligned_size > 0) {
+        wgpuQueueWriteBuffer(ib->queue, ib->buffer, 0, data, aligned_size);
+    }
+    // An odd number of 16-bit indices leaves one; pad it to a full word (the
+    // buffer size is rounded up, so the padding stays inside it)
+    if (aligned_size < data_size) {
+        uint8_t tail[4] = {0};
+        memcpy(tail, (const uint8_t*)data + aligned_size, data_size - aligned_size);
+        wgpuQueueWriteBuffer(ib->queue, ib->buffer, aligned_size, tail, sizeof(tail));
+    }
+    UG_PROFILE_END();
+
+    UGFrameCounters* counters = ug_context_get_frame_counters(ib->context);
+    if (counters) counters->upload_bytes += ALIGN4(data_size);
+}
+
+WGPUBuffer ug_index_buffer_get_handle(UGIndexBuffer* ib) {
+    return ib ? ib->buffer : NULL;
+}
+
+WGPUIndexFormat ug_index_buffer_get_format(UGIndexBuffer* ib) {
+    return ib ? ib->format : WGPUIndexFormat_Undefined;
+}
+
+size_t ug_index_buffer_get_capacity(UGIndexBuffer* ib) {
+    return ib ? ib->capacity : 0;
+}
+
+UGBundleLinks* ug_index_buffer_get_bundle_links(UGIndexBuffer* ib) {
+    return ib ? &ib->bundle_links : NULL;
+}
+
+void ug_index_buffer_destroy(UGIndexBuffer* ib) {
+    if (ib) {
+        ug_bundle_links_release(&ib->bundle_links);
+        if (ib->buffer) {
+            wgpuBufferRelease(ib->buffer);
+        }
+        free(ib);
+    }
+}
+
+UGIndexBuffer* ug_index_buffer_create_quads(UGContext* context, uint32_t quad_count) {
+    if (!context || quad_count == 0 || quad_count > UG_QUAD_INDEX_MAX_QUADS) {
+        return NULL;
+    }
+
+    UGIndexBuffer* ib = ug_index_buffer_create(context, WGPUIndexFormat_Uint16, (size_t)quad_count * 6);
+    if (!ib) {
+        return NULL;
+    }
+
+    uint16_t* indices = (uint16_t*)malloc((size_t)quad_count * 6 * sizeof(uint16_t));
+    if (!indices) {
+        ug_index_buffer_destroy(ib);
+        return NULL;
+    }
+
+    // Same triangles as the 6-vertex emitters: (0, 1, 2) and (2, 1, 3)
+    for (uint32_t q = 0; q < quad_count; q++) {
+        uint16_t base = (uint16_t)(q * 4);
+        uint16_t* quad = &indices[q * 6];
+        quad[0] = base;
+        quad[1] = base + 1;
+        quad[2] = base + 2;
+        quad[3] = base + 2;
+        quad[4] = base + 1;
+        quad[5] = base + 3;
+    }
+    ug_index_buffer_update(ib, indices, (size_t)quad_count * 6);
+    free(indices);
+
+    return ib;
+}
@@ -0,0 +1,90 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdlib.h>
+
+// Indirect argument buffer: an array of draw commands read by the GPU
+// Storage usage lets compute passes write commands (and counts) directly
+struct UGIndirectBuffer {
+    UGContext* context;
+    WGPUBuffer buffer;
+    WGPUQueue queue;
+    bool indexed;
+    size_t capacity;        // Maximum number of commands
+    size_t command_size;    // sizeof(UGDrawIndirectArgs) or sizeof(UGDrawIndexedIndirectArgs)
+};
+
+UGIndirectBuffer* ug_indirect_buffer_create(UGContext* context, bool indexed, size_t max_commands) {
+    if (!context || max_commands == 0) {
+        return NULL;
+    }
+
+    UGIndirectBuffer* ib = (UGIndirectBuffer*)calloc(1, sizeof(UGIndirectBuffer));
+    if (!ib) {
+        return NULL;
+    }
+
+    ib->command_size = indexed ? sizeof(UGDrawIndexedIndirectArgs) : sizeof(UGDrawIndirectArgs);
+    WGPUBufferDescriptor buffer_desc = {
+        .size = ib->command_size * max_commands,
+        .usage = WGPUBufferUsage_Indirect | WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+        .mappedAtCreation = false,
+    };
+
+    ib->context = context;
+    ib->buffer = wgpuDeviceCreateBuffer(ug_context_get_device(context), &buffer_desc);
+    ib->queue = ug_context_get_queue(context);
+    ib->indexed = indexed;
+    ib->capacity = max_commands;
+    if (!ib->buffer) {
+        free(ib);
+        return NULL;
+    }
+
+    return ib;
+}
+
+void ug_indirect_buffer_update(UGIndirectBuffer* ib, const void* commands, size_t first_command,
+                               size_t command_count) {
+    if (!ib || !commands || command_count == 0 || first_command >= ib->capacity) {
+        return;
+    }
+
+    if (command_count > ib->capacity - first_command) {
+        command_count = ib->capacity - first_command;
+    }
+    // Both command sizes are multiples of 4, as queue writes require
+    size_t data_size = command_count * ib->command_size;
+
+    UG_PROFILE_BEGIN("ug_indirect_buffer_update");
+    wgpuQueueWriteBuffer(ib->queue, ib->buffer, first_command * ib->command_size, commands, data_size);
+    UG_PROFILE_END();
+
+    UGFrameCounters* counters = ug_context_get_frame_counters(ib->context);
+    if (counters) counters->upload_bytes += data_size;
+}
+
+WGPUBuffer ug_indirect_buffer_get_handle(UGIndirectBuffer* ib) {
+    return ib ? ib->buffer : NULL;
+}
+
+bool ug_indirect_buffer_is_indexed(UGIndirectBuffer* ib) {
+    return ib ? ib->indexed : false;
+}
+
+size_t ug_indirect_buffer_get_capacity(UGIndirectBuffer* ib) {
+    return ib ? ib->capacity : 0;
+}
+
+size_t ug_indirect_buffer_get_command_size(UGIndirectBuffer* ib) {
+    return ib ? ib->command_size : 0;
+}
+
+void ug_indirect_buffer_destroy(UGIndirectBuffer* ib) {
+    if (ib) {
+        if (ib->buffer) {
+            wgpuBufferRelease(ib->buffer);
+        }
+        free(ib);
+    }
+}
@@ -0,0 +1,258 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Binary input log. After an 8 byte header ("UGIN" + little-endian u32
+// version) the file is a stream of records, each a one byte tag followed by
+// its payload. Integers are LEB128 varints and cursor positions raw
+// little-endian doubles, so a frame with no input costs 2-4 bytes. A frame
+// record closes the frame: every input record before it was delivered
+// before that frame's delta_time was taken.
+
+#define INPUT_LOG_MAGIC "UGIN"
+#define INPUT_LOG_VERSION 1
+
+enum {
+    RECORD_FRAME = 1,        // varint delta_ns
+    RECORD_KEY_DOWN,         // varint key + 1
+    RECORD_KEY_UP,           // varint key + 1
+    RECORD_MOUSE_MOVE,       // f64 x, f64 y
+    RECORD_BUTTON_DOWN,      // u8 button
+    RECORD_BUTTON_UP,        // u8 button
+};
+
+struct UGInputLog {
+    FILE* file;
+    UGWindow* window;        // Replayed events are dispatched here; may be NULL
+    bool replay;
+    bool finished;           // Replay ran out of frames
+};
+
+static void write_varint(FILE* file, uint64_t value) {
+    unsigned char bytes[10];
+    size_t count = 0;
+    do {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        bytes[count++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    fwrite(bytes, 1, count, file);
+}
+
+static bool read_varint(FILE* file, uint64_t* out_value) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = fgetc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *out_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void write_f64(FILE* file, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char)(bits >> (i * 8));
+    }
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+static bool read_f64(FILE* file, double* out_value) {
+    unsigned char bytes[8];
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+        return false;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits |= (uint64_t)bytes[i] << (i * 8);
+    }
+    memcpy(out_value, &bits, sizeof(*out_value));
+    return true;
+}
+
+// Read input records up to the next frame record and return its delta;
+// dispatch is false when only looking ahead
+static bool replay_frame(UGInputLog* log, uint64_t* out_delta_ns, bool dispatch) {
+    for (;;) {
+        int tag = fgetc(log->file);
+        uint64_t value;
+        double x, y;
+        int button;
+
+        switch (tag) {
+            case RECORD_FRAME:
+                return read_varint(log->file, out_delta_ns);
+            case RECORD_KEY_DOWN:
+            case RECORD_KEY_UP:
+                if (!read_varint(log->file, &value)) {
+                    return false;
+                }
+                if (dispatch) {
+                    ug_window_dispatch_key(log->window, (int)(uint32_t)value - 1, tag == RECORD_KEY_DOWN);
+                }
+                break;
+            case RECORD_MOUSE_MOVE:
+                if (!read_f64(log->file, &x) || !read_f64(log->file, &y)) {
+                    return false;
+                }
+                if (dispatch) {
+                    ug_window_dispatch_mouse_move(log->window, x, y);
+                }
+                break;
+            case RECORD_BUTTON_DOWN:
+            case RECORD_BUTTON_UP:
+                button = fgetc(log->file);
+                if (button == EOF) {
+                    return false;
+                }
+                if (dispatch) {
+                    ug_window_dispatch_mouse_button(log->window, (UGMouseButton)button, tag == RECORD_BUTTON_DOWN);
+                }
+                break;
+            default:
+                // End of file, or a record this version doesn't know
+                return false;
+        }
+    }
+}
+
+static bool has_next_frame(UGInputLog* log) {
+    long position = ftell(log->file);
+    uint64_t delta_ns;
+    bool found = replay_frame(log, &delta_ns, false);
+    fseek(log->file, position, SEEK_SET);
+    return found;
+}
+
+static UGInputLog* input_log_open(const char* path, UGWindow* window, bool replay) {
+    if (!path) {
+        return NULL;
+    }
+
+    FILE* file = fopen(path, replay ? "rb" : "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to open input log: %s\n", path);
+        return NULL;
+    }
+
+    unsigned char header[8];
+    if (replay) {
+        uint32_t version = 0;
+        if (fread(header, 1, sizeof(header), file) == sizeof(header)) {
+            version = header[4] | header[5] << 8 | header[6] << 16 | (uint32_t)header[7] << 24;
+        }
+        if (memcmp(header, INPUT_LOG_MAGIC, 4) != 0 || version != INPUT_LOG_VERSION) {
+            fprintf(stderr, "Not a supported input log: %s\n", path);
+            fclose(file);
+            return NULL;
+        }
+    } else {
+        memcpy(header, INPUT_LOG_MAGIC, 4);
+        for (int i = 0; i < 4; i++) {
+            header[4 + i] = (unsigned char)(INPUT_LOG_VERSION >> (i * 8));
+        }
+        fwrite(header, 1, sizeof(header), file);
+    }
+
+    UGInputLog* log = (UGInputLog*)calloc(1, sizeof(UGInputLog));
+    if (!log) {
+        fclose(file);
+        return NULL;
+    }
+    log->file = file;
+    log->window = window;
+    log->replay = replay;
+
+    if (replay) {
+        log->finished = !has_next_frame(log);
+    }
+    return log;
+}
+
+UGInputLog* ug_input_log_open_record(const char* path, UGWindow* window) {
+    return input_log_open(path, window, false);
+}
+
+UGInputLog* ug_input_log_open_replay(const char* path, UGWindow* window) {
+    return input_log_open(path, window, true);
+}
+
+void ug_input_log_close(UGInputLog* log) {
+    if (!log) {
+        return;
+    }
+    if (fclose(log->file) != 0 && !log->replay) {
+        fprintf(stderr, "Failed to write input log\n");
+    }
+    free(log);
+}
+
+bool ug_input_log_is_replaying(UGInputLog* log) {
+    return log && log->replay;
+}
+
+bool ug_input_log_finished(UGInputLog* log) {
+    return log && log->finished;
+}
+
+void ug_input_log_write_key(UGInputLog* log, int key, bool pressed) {
+    if (!log || log->replay) {
+        return;
+    }
+    fputc(pressed ? RECORD_KEY_DOWN : RECORD_KEY_UP, log->file);
+    write_varint(log->file, (uint64_t)(uint32_t)(key + 1));  // GLFW_KEY_UNKNOWN is -1
+}
+
+void ug_input_log_write_mouse_move(UGInputLog* log, double x, double y) {
+    if (!log || log->replay) {
+        return;
+    }
+    fputc(RECORD_MOUSE_MOVE, log->file);
+    write_f64(log->file, x);
+    write_f64(log->file, y);
+}
+
+void ug_input_log_write_mouse_button(UGInputLog* log, UGMouseButton button, bool pressed) {
+    if (!log || log->replay) {
+        return;
+    }
+    fputc(pressed ? RECORD_BUTTON_DOWN : RECORD_BUTTON_UP, log->file);
+    fputc((int)button, log->file);
+}
+
+uint64_t ug_input_log_frame(UGInputLog* log, uint64_t delta_ns) {
+    if (!log) {
+        return delta_ns;
+    }
+
+    if (!log->replay) {
+        fputc(RECORD_FRAME, log->file);
+        write_varint(log->file, delta_ns);
+        return delta_ns;
+    }
+
+    if (log->finished) {
+        return 0;
+    }
+
+    uint64_t logged_ns = 0;
+    if (!replay_frame(log, &logged_ns, true)) {
+        log->finished = true;
+        return 0;
+    }
+
+    // Stop as soon as the last frame is handed out rather than one frame late;
+    // input recorded after the last frame is never delivered
+    log->finished = !has_next_frame(log);
+    return logged_ns;
+}
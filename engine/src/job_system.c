@@ -0,0 +1,582 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#if defined(__APPLE__)
+#define _DARWIN_C_SOURCE
+#endif
+
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#define UG_JOBS_THREADED 1
+#endif
+
+// Work-stealing job system. Each worker owns a Chase-Lev deque: it pushes and
+// pops at the bottom, idle workers steal from the top. Threads that are not
+// workers (main, render) submit through a shared injection queue. Without
+// pthreads the system has no workers and every job runs inline on submit.
+
+#define DEQUE_CAPACITY 4096   // Per worker (power of two); a full deque runs jobs inline
+#define IDLE_SPINS 32         // Failed job searches before a worker goes to sleep
+#define PARALLEL_FOR_MAX_BATCHES 64
+
+typedef struct {
+    UGJobFunction function;
+    void* data;
+    UGJobCounter* counter;
+} Job;
+
+// Deque slots are read by thieves while the owner may write neighbouring
+// slots, so the fields are individually atomic
+typedef struct {
+    _Atomic(UGJobFunction) function;
+    _Atomic(void*) data;
+    _Atomic(UGJobCounter*) counter;
+} JobSlot;
+
+typedef struct {
+    atomic_int_fast64_t top;
+    atomic_int_fast64_t bottom;
+    JobSlot slots[DEQUE_CAPACITY];
+} JobDeque;
+
+// Jobs held back until a dependency counter reaches zero
+typedef struct UGJobContinuation {
+    struct UGJobContinuation* next;
+    UGJobCounter* counter;
+    uint32_t count;
+    UGJobDesc jobs[];
+} UGJobContinuation;
+
+struct UGJobCounter {
+    atomic_int pending;
+    atomic_flag lock;                   // Guards continuations
+    UGJobContinuation* continuations;
+};
+
+#if defined(UG_JOBS_THREADED)
+typedef struct {
+    UGJobSystem* system;
+    uint32_t index;
+    pthread_t thread;
+    bool started;
+} JobWorker;
+#endif
+
+struct UGJobSystem {
+    uint32_t worker_count;
+    atomic_int queued;                  // Jobs submitted to queues and not yet taken
+#if defined(UG_JOBS_THREADED)
+    JobWorker* workers;
+    JobDeque* deques;                   // One per worker
+
+    pthread_mutex_t inject_lock;        // Injection queue for non-worker threads
+    Job* inject;
+    size_t inject_head;
+    size_t inject_count;
+    size_t inject_capacity;
+
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+    atomic_int sleeping;
+    atomic_bool running;
+#endif
+};
+
+#if defined(UG_JOBS_THREADED)
+static _Thread_local UGJobSystem* t_system = NULL;
+static _Thread_local uint32_t t_worker_index = 0;
+static _Thread_local uint32_t t_steal_seed = 0;
+#endif
+
+static void execute_job(UGJobSystem* system, const Job* job);
+
+// Counters
+static void counter_init(UGJobCounter* counter) {
+    atomic_init(&counter->pending, 0);
+    atomic_flag_clear(&counter->lock);
+    counter->continuations = NULL;
+}
+
+static void counter_lock(UGJobCounter* counter) {
+    while (atomic_flag_test_and_set_explicit(&counter->lock, memory_order_acquire)) {
+    }
+}
+
+static void counter_unlock(UGJobCounter* counter) {
+    atomic_flag_clear_explicit(&counter->lock, memory_order_release);
+}
+
+// The last job decrements under the lock, so once a waiter has seen zero and
+// passed through the lock, no other thread touches the counter again
+static bool counter_is_done(UGJobCounter* counter) {
+    if (atomic_load(&counter->pending) > 0) {
+        return false;
+    }
+    counter_lock(counter);
+    counter_unlock(counter);
+    return true;
+}
+
+UGJobCounter* ug_job_counter_create(void) {
+    UGJobCounter* counter = (UGJobCounter*)malloc(sizeof(UGJobCounter));
+    if (counter) {
+        counter_init(counter);
+    }
+    return counter;
+}
+
+void ug_job_counter_destroy(UGJobCounter* counter) {
+    free(counter);
+}
+
+bool ug_job_counter_is_done(UGJobCounter* counter) {
+    return !counter || counter_is_done(counter);
+}
+
+#if defined(UG_JOBS_THREADED)
+// Chase-Lev deque (C11 formulation by Le et al.)
+static bool deque_push(JobDeque* deque, const Job* job) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= DEQUE_CAPACITY) {
+        return false;
+    }
+
+    JobSlot* slot = &deque->slots[bottom & (DEQUE_CAPACITY - 1)];
+    atomic_store_explicit(&slot->function, job->function, memory_order_relaxed);
+    atomic_store_explicit(&slot->data, job->data, memory_order_relaxed);
+    atomic_store_explicit(&slot->counter, job->counter, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+static void read_slot(JobSlot* slot, Job* out) {
+    out->function = atomic_load_explicit(&slot->function, memory_order_relaxed);
+    out->data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+    out->counter = atomic_load_explicit(&slot->counter, memory_order_relaxed);
+}
+
+static bool deque_pop(JobDeque* deque, Job* out) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    read_slot(&deque->slots[bottom & (DEQUE_CAPACITY - 1)], out);
+    if (top == bottom) {
+        // Last job: race thieves for it
+        bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                           memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+static bool deque_steal(JobDeque* deque, Job* out) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return false;
+    }
+
+    read_slot(&deque->slots[top & (DEQUE_CAPACITY - 1)], out);
+    return atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                   memory_order_seq_cst, memory_order_relaxed);
+}
+
+// Injection queue - a growable ring under a mutex
+static bool inject_push(UGJobSystem* system, const Job* job) {
+    pthread_mutex_lock(&system->inject_lock);
+    if (system->inject_count == system->inject_capacity) {
+        size_t capacity = system->inject_capacity ? system->inject_capacity * 2 : 256;
+        Job* grown = (Job*)malloc(capacity * sizeof(Job));
+        if (!grown) {
+            pthread_mutex_unlock(&system->inject_lock);
+            return false;
+        }
+        for (size_t i = 0; i < system->inject_count; i++) {
+            grown[i] = system->inject[(system->inject_head + i) % system->inject_capacity];
+        }
+        free(system->inject);
+        system->inject = grown;
+        system->inject_head = 0;
+        system->inject_capacity = capacity;
+    }
+
+    system->inject[(system->inject_head + system->inject_count) % system->inject_capacity] = *job;
+    system->inject_count++;
+    pthread_mutex_unlock(&system->inject_lock);
+    return true;
+}
+
+static bool inject_pop(UGJobSystem* system, Job* out) {
+    pthread_mutex_lock(&system->inject_lock);
+    bool found = system->inject_count > 0;
+    if (found) {
+        *out = system->inject[system->inject_head];
+        system->inject_head = (system->inject_head + 1) % system->inject_capacity;
+        system->inject_count--;
+    }
+    pthread_mutex_unlock(&system->inject_lock);
+    return found;
+}
+
+// Own deque first, then the injection queue, then steal from a random victim
+static bool take_job(UGJobSystem* system, Job* out) {
+    if (atomic_load(&system->queued) <= 0) {
+        return false;
+    }
+
+    bool is_worker = t_system == system && t_worker_index > 0;
+    uint32_t self = is_worker ? t_worker_index - 1 : UINT32_MAX;
+
+    bool found = (is_worker && deque_pop(&system->deques[self], out)) || inject_pop(system, out);
+    if (!found) {
+        t_steal_seed = t_steal_seed * 1664525u + 1013904223u;
+        uint32_t start = t_steal_seed % system->worker_count;
+        for (uint32_t i = 0; i < system->worker_count && !found; i++) {
+            uint32_t victim = (start + i) % system->worker_count;
+            if (victim != self) {
+                found = deque_steal(&system->deques[victim], out);
+            }
+        }
+    }
+
+    if (found) {
+        atomic_fetch_sub(&system->queued, 1);
+    }
+    return found;
+}
+
+static void wake_workers(UGJobSystem* system) {
+    if (atomic_load(&system->sleeping) > 0) {
+        pthread_mutex_lock(&system->sleep_lock);
+        pthread_cond_broadcast(&system->wake);
+        pthread_mutex_unlock(&system->sleep_lock);
+    }
+}
+
+static void* worker_main(void* arg) {
+    JobWorker* worker = (JobWorker*)arg;
+    UGJobSystem* system = worker->system;
+    t_system = system;
+    t_worker_index = worker->index + 1;
+    t_steal_seed = worker->index * 2654435761u + 1;
+
+    uint32_t idle = 0;
+    while (atomic_load(&system->running)) {
+        Job job;
+        if (take_job(system, &job)) {
+            UG_PROFILE_BEGIN("job");
+            execute_job(system, &job);
+            UG_PROFILE_END();
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < IDLE_SPINS) {
+            sched_yield();
+            continue;
+        }
+
+        // Sleeping is announced before re-checking the queue, and submitters
+        // bump the queue before checking for sleepers, so no wake-up is lost
+        pthread_mutex_lock(&system->sleep_lock);
+        atomic_fetch_add(&system->sleeping, 1);
+        while (atomic_load(&system->running) && atomic_load(&system->queued) <= 0) {
+            pthread_cond_wait(&system->wake, &system->sleep_lock);
+        }
+        atomic_fetch_sub(&system->sleeping, 1);
+        pthread_mutex_unlock(&system->sleep_lock);
+        idle = 0;
+    }
+
+    return NULL;
+}
+
+static uint32_t hardware_thread_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+}
+#endif // UG_JOBS_THREADED
+
+// Queue jobs whose counter has already been incremented
+static void submit_jobs(UGJobSystem* system, const UGJobDesc* jobs, uint32_t count, UGJobCounter* counter) {
+    for (uint32_t i = 0; i < count; i++) {
+        Job job = {jobs[i].function, jobs[i].data, counter};
+        if (!job.function) {
+            execute_job(system, &job);
+            continue;
+        }
+
+#if defined(UG_JOBS_THREADED)
+        if (system && system->worker_count > 0) {
+            bool is_worker = t_system == system && t_worker_index > 0;
+            bool queued = is_worker ? deque_push(&system->deques[t_worker_index - 1], &job)
+                                    : inject_push(system, &job);
+            if (queued) {
+                atomic_fetch_add(&system->queued, 1);
+                continue;
+            }
+        }
+#endif
+        // No workers, or the queue is full: run it here
+        execute_job(system, &job);
+    }
+
+#if defined(UG_JOBS_THREADED)
+    if (system && system->worker_count > 0) {
+        wake_workers(system);
+    }
+#endif
+}
+
+static void counter_finish_job(UGJobSystem* system, UGJobCounter* counter) {
+    counter_lock(counter);
+    UGJobContinuation* continuation = NULL;
+    if (atomic_fetch_sub(&counter->pending, 1) == 1) {
+        continuation = counter->continuations;
+        counter->continuations = NULL;
+    }
+    counter_unlock(counter);
+
+    while (continuation) {
+        UGJobContinuation* next = continuation->next;
+        submit_jobs(system, continuation->jobs, continuation->count, continuation->counter);
+        free(continuation);
+        continuation = next;
+    }
+}
+
+static void execute_job(UGJobSystem* system, const Job* job) {
+    if (job->function) {
+        job->function(job->data);
+    }
+    if (job->counter) {
+        counter_finish_job(system, job->counter);
+    }
+}
+
+UGJobSystem* ug_job_system_create(uint32_t worker_count) {
+    UGJobSystem* system = (UGJobSystem*)calloc(1, sizeof(UGJobSystem));
+    if (!system) {
+        return NULL;
+    }
+    atomic_init(&system->queued, 0);
+
+#if defined(UG_JOBS_THREADED)
+    // One worker per hardware thread besides the caller's own
+    if (worker_count == UG_JOB_WORKERS_AUTO) {
+        worker_count = hardware_thread_count() - 1;
+    }
+    if (worker_count > UG_JOB_MAX_WORKERS) {
+        worker_count = UG_JOB_MAX_WORKERS;
+    }
+
+    pthread_mutex_init(&system->inject_lock, NULL);
+    pthread_mutex_init(&system->sleep_lock, NULL);
+    pthread_cond_init(&system->wake, NULL);
+    atomic_init(&system->sleeping, 0);
+    atomic_init(&system->running, true);
+
+    if (worker_count == 0) {
+        return system;
+    }
+
+    system->workers = (JobWorker*)calloc(worker_count, sizeof(JobWorker));
+    system->deques = (JobDeque*)calloc(worker_count, sizeof(JobDeque));
+    if (!system->workers || !system->deques) {
+        ug_job_system_destroy(system);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < worker_count; i++) {
+        atomic_init(&system->deques[i].top, 0);
+        atomic_init(&system->deques[i].bottom, 0);
+    }
+
+    system->worker_count = worker_count;
+    for (uint32_t i = 0; i < worker_count; i++) {
+        JobWorker* worker = &system->workers[i];
+        worker->system = system;
+        worker->index = i;
+        worker->started = pthread_create(&worker->thread, NULL, worker_main, worker) == 0;
+        if (!worker->started) {
+            fprintf(stderr, "Failed to start job worker %u\n", i);
+            ug_job_system_destroy(system);
+            return NULL;
+        }
+    }
+#else
+    (void)worker_count;
+#endif
+
+    return system;
+}
+
+void ug_job_system_destroy(UGJobSystem* system) {
+    if (!system) {
+        return;
+    }
+
+#if defined(UG_JOBS_THREADED)
+    pthread_mutex_lock(&system->sleep_lock);
+    atomic_store(&system->running, false);
+    pthread_cond_broadcast(&system->wake);
+    pthread_mutex_unlock(&system->sleep_lock);
+
+    if (system->workers) {
+        for (uint32_t i = 0; i < system->worker_count; i++) {
+            if (system->workers[i].started) {
+                pthread_join(system->workers[i].thread, NULL);
+            }
+        }
+    }
+
+    pthread_cond_destroy(&system->wake);
+    pthread_mutex_destroy(&system->sleep_lock);
+    pthread_mutex_destroy(&system->inject_lock);
+    free(system->inject);
+    free(system->deques);
+    free(system->workers);
+#endif
+    free(system);
+}
+
+uint32_t ug_job_system_get_thread_count(UGJobSystem* system) {
+    return system ? system->worker_count + 1 : 1;
+}
+
+void ug_jobs_run(UGJobSystem* system, const UGJobDesc* jobs, uint32_t count, UGJobCounter* counter) {
+    ug_jobs_run_after(system, NULL, jobs, count, counter);
+}
+
+void ug_jobs_run_after(UGJobSystem* system, UGJobCounter* dependency, const UGJobDesc* jobs,
+                       uint32_t count, UGJobCounter* counter) {
+    if (!jobs || count == 0) {
+        return;
+    }
+
+    // The counter covers held-back jobs too, so waiting on it waits for them
+    if (counter) {
+        atomic_fetch_add(&counter->pending, (int)count);
+    }
+
+    if (dependency && atomic_load(&dependency->pending) > 0) {
+        UGJobContinuation* continuation =
+            (UGJobContinuation*)malloc(sizeof(UGJobContinuation) + count * sizeof(UGJobDesc));
+        if (!continuation) {
+            ug_jobs_wait(system, dependency);
+        } else {
+            continuation->counter = counter;
+            continuation->count = count;
+            for (uint32_t i = 0; i < count; i++) {
+                continuation->jobs[i] = jobs[i];
+            }
+
+            counter_lock(dependency);
+            if (atomic_load(&dependency->pending) > 0) {
+                continuation->next = dependency->continuations;
+                dependency->continuations = continuation;
+                counter_unlock(dependency);
+                return;
+            }
+            counter_unlock(dependency);
+            free(continuation);
+        }
+    }
+
+    submit_jobs(system, jobs, count, counter);
+}
+
+void ug_jobs_wait(UGJobSystem* system, UGJobCounter* counter) {
+    if (!counter) {
+        return;
+    }
+
+    // Help with queued work instead of blocking
+    while (!counter_is_done(counter)) {
+#if defined(UG_JOBS_THREADED)
+        Job job;
+        if (system && system->worker_count > 0 && take_job(system, &job)) {
+            execute_job(system, &job);
+        } else {
+            sched_yield();
+        }
+#else
+        (void)system;
+#endif
+    }
+}
+
+// parallel_for: the range is cut into contiguous batches, one runs on the
+// calling thread and the rest are queued
+typedef struct {
+    UGParallelForFunction function;
+    void* data;
+    uint32_t begin;
+    uint32_t end;
+} ForBatch;
+
+static void run_for_batch(void* data) {
+    ForBatch* batch = (ForBatch*)data;
+    batch->function(batch->begin, batch->end, batch->data);
+}
+
+void ug_parallel_for(UGJobSystem* system, uint32_t count, uint32_t min_batch_size,
+                     UGParallelForFunction function, void* data) {
+    if (!function || count == 0) {
+        return;
+    }
+    if (min_batch_size == 0) {
+        min_batch_size = 1;
+    }
+
+    uint32_t threads = ug_job_system_get_thread_count(system);
+    uint32_t batch_count = (count + min_batch_size - 1) / min_batch_size;
+    if (batch_count > threads * 4) {
+        batch_count = threads * 4;
+    }
+    if (batch_count > PARALLEL_FOR_MAX_BATCHES) {
+        batch_count = PARALLEL_FOR_MAX_BATCHES;
+    }
+    if (threads == 1 || batch_count <= 1) {
+        function(0, count, data);
+        return;
+    }
+
+    ForBatch batches[PARALLEL_FOR_MAX_BATCHES];
+    UGJobDesc jobs[PARALLEL_FOR_MAX_BATCHES];
+    uint32_t per_batch = count / batch_count;
+    uint32_t remainder = count % batch_count;
+    uint32_t begin = 0;
+    for (uint32_t i = 0; i < batch_count; i++) {
+        uint32_t size = per_batch + (i < remainder ? 1 : 0);
+        batches[i] = (ForBatch){function, data, begin, begin + size};
+        jobs[i] = (UGJobDesc){run_for_batch, &batches[i]};
+        begin += size;
+    }
+
+    UGJobCounter counter;
+    counter_init(&counter);
+    ug_jobs_run(system, jobs + 1, batch_count - 1, &counter);
+    run_for_batch(&batches[0]);
+    ug_jobs_wait(system, &counter);
+}
@@ -25,11 +25,18 @@ struct UGPipelineBuilder {
     WGPUShaderModule shader_module;
     WGPUTextureFormat surface_format;
     WGPUPipelineLayout layout;
-    WGPUVertexBufferLayout* vertex_buffers;
+    WGPUVertexBufferLayout vertex_buffers[UG_RENDER_PASS_MAX_VERTEX_BUFFERS];  // Index = buffer slot
     size_t vertex_buffer_count;
     bool enable_blending;
     WGPUPrimitiveTopology topology;
 
+    // Depth state; disabled pipelines only work in passes without a depth attachment
+    bool depth_enabled;
+    bool depth_write;
+    WGPUCompareFunction depth_compare;
+    WGPUTextureFormat depth_format;
+    uint32_t sample_count;          // Must match the passes the pipeline is used in
+
     // Integrated bind group support
     UGBindEntry* bind_entries;
     size_t bind_entry_count;
@@ -49,6 +56,8 @@ UGPipelineBuilder* ug_pipeline_builder_create(UGContext* context, const char* sh
 
     builder->device = ug_context_get_device(context);
     builder->surface_format = ug_context_get_surface_format(context);
+    builder->depth_format = ug_context_get_depth_format(context);
+    builder->sample_count = ug_context_get_sample_count(context);
     builder->topology = WGPUPrimitiveTopology_TriangleList;
     builder->enable_blending = false;
     builder->auto_create_layout = true;
@@ -79,11 +88,17 @@ void ug_pipeline_builder_set_layout(UGPipelineBuilder* builder, WGPUPipelineLayo
 
 void ug_pipeline_builder_set_vertex_buffer(UGPipelineBuilder* builder, WGPUVertexBufferLayout* layout) {
     if (builder && layout) {
-        builder->vertex_buffers = layout;
+        builder->vertex_buffers[0] = *layout;
         builder->vertex_buffer_count = 1;
     }
 }
 
+void ug_pipeline_builder_add_vertex_buffer(UGPipelineBuilder* builder, WGPUVertexBufferLayout* layout) {
+    if (builder && layout && builder->vertex_buffer_count < UG_RENDER_PASS_MAX_VERTEX_BUFFERS) {
+        builder->vertex_buffers[builder->vertex_buffer_count++] = *layout;
+    }
+}
+
 void ug_pipeline_builder_enable_blending(UGPipelineBuilder* builder, bool enable) {
     if (builder) {
         builder->enable_blending = enable;
@@ -96,6 +111,26 @@ void ug_pipeline_builder_set_topology(UGPipelineBuilder* builder, WGPUPrimitiveT
     }
 }
 
+void ug_pipeline_builder_set_depth_test(UGPipelineBuilder* builder, WGPUCompareFunction compare, bool write) {
+    if (builder) {
+        builder->depth_enabled = true;
+        builder->depth_compare = compare;
+        builder->depth_write = write;
+    }
+}
+
+void ug_pipeline_builder_set_depth_format(UGPipelineBuilder* builder, WGPUTextureFormat format) {
+    if (builder) {
+        builder->depth_format = format;
+    }
+}
+
+void ug_pipeline_builder_set_sample_count(UGPipelineBuilder* builder, uint32_t sample_count) {
+    if (builder && sample_count > 0) {
+        builder->sample_count = sample_count;
+    }
+}
+
 void ug_pipeline_builder_add_uniform(UGPipelineBuilder* builder, uint32_t binding,
                                       UGUniformBuffer* uniform, WGPUShaderStage visibility) {
     if (!builder || !uniform || builder->bind_entry_count >= builder->bind_entry_capacity) {
@@ -215,6 +250,18 @@ WGPURenderPipeline ug_pipeline_builder_build(UGPipelineBuilder* builder) {
         .targets = &color_target,
     };
 
+    WGPUDepthStencilState depth_stencil = {
+        .format = builder->depth_format,
+        .depthWriteEnabled = builder->depth_write ? WGPUOptionalBool_True : WGPUOptionalBool_False,
+        .depthCompare = builder->depth_compare,
+        .stencilFront = {WGPUCompareFunction_Always, WGPUStencilOperation_Keep,
+                         WGPUStencilOperation_Keep, WGPUStencilOperation_Keep},
+        .stencilBack = {WGPUCompareFunction_Always, WGPUStencilOperation_Keep,
+                        WGPUStencilOperation_Keep, WGPUStencilOperation_Keep},
+        .stencilReadMask = ~0u,
+        .stencilWriteMask = ~0u,
+    };
+
     WGPURenderPipelineDescriptor pipeline_desc = {
         .layout = layout_to_use,
         .vertex = {
@@ -227,11 +274,12 @@ WGPURenderPipeline ug_pipeline_builder_build(UGPipelineBuilder* builder) {
             .topology = builder->topology,
         },
         .multisample = {
-            .count = 1,
+            .count = builder->sample_count,
             .mask = ~0u,
             .alphaToCoverageEnabled = false,
         },
         .fragment = &fragment_state,
+        .depthStencil = builder->depth_enabled ? &depth_stencil : NULL,
     };
 
     return wgpuDeviceCreateRenderPipeline(builder->device, &pipeline_desc);
@@ -0,0 +1,259 @@
+#include "ungrund.h"
+#include <stdio.h>
+
+#if defined(UG_ENABLE_PROFILING)
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#define UG_PROFILE_THREADED 1
+#endif
+
+// Each thread records completed zones into its own ring, so recording takes
+// no locks. Rings are registered on a lock-free list on first use and released
+// when their thread exits (with pthreads; otherwise they live until exit).
+// The exporter copies a ring while its thread may still be writing and keeps
+// only the slots the write index shows were not overwritten during the copy.
+
+#define PROFILE_RING_SIZE 16384   // Completed zones kept per thread (power of two)
+#define PROFILE_MAX_DEPTH 64      // Deepest zone nesting tracked per thread
+
+typedef struct {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+} ProfileEvent;
+
+// Slot fields are atomics so the exporter can read them mid-write; the
+// snapshot discards any slot that may be torn
+typedef struct {
+    _Atomic(const char*) name;
+    atomic_uint_fast64_t start_ns;
+    atomic_uint_fast64_t duration_ns;
+} ProfileSlot;
+
+typedef struct ProfileThread {
+    struct ProfileThread* next;   // Set before publishing, then only under g_export_lock
+    uint32_t thread_id;
+    atomic_uint_fast64_t head;    // Total events written; the ring keeps the latest
+    ProfileSlot events[PROFILE_RING_SIZE];
+
+    // Open zones, only touched by the owning thread
+    const char* open_names[PROFILE_MAX_DEPTH];
+    uint64_t open_starts[PROFILE_MAX_DEPTH];
+    uint32_t depth;
+} ProfileThread;
+
+static _Atomic(ProfileThread*) g_threads = NULL;
+static atomic_uint g_next_thread_id = 1;
+static _Thread_local ProfileThread* t_thread = NULL;
+
+#if defined(UG_PROFILE_THREADED)
+// Serializes exports against rings being unlinked and freed
+static pthread_mutex_t g_export_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_thread_key;
+static bool g_key_valid = false;
+
+static void release_thread(void* value) {
+    ProfileThread* thread = (ProfileThread*)value;
+    t_thread = NULL;
+
+    pthread_mutex_lock(&g_export_lock);
+    // Pushes only ever swap the list head, so unlink there first and fall back
+    // to the predecessor once a newer ring has been pushed in front
+    ProfileThread* expected = thread;
+    if (!atomic_compare_exchange_strong(&g_threads, &expected, thread->next)) {
+        for (ProfileThread* prev = atomic_load(&g_threads); prev; prev = prev->next) {
+            if (prev->next == thread) {
+                prev->next = thread->next;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_export_lock);
+    free(thread);
+}
+
+static void create_thread_key(void) {
+    g_key_valid = pthread_key_create(&g_thread_key, release_thread) == 0;
+}
+#endif
+
+static ProfileThread* profile_thread(void) {
+    if (t_thread) {
+        return t_thread;
+    }
+
+    ProfileThread* thread = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+    if (!thread) {
+        return NULL;
+    }
+    thread->thread_id = atomic_fetch_add(&g_next_thread_id, 1);
+    atomic_init(&thread->head, 0);
+
+    ProfileThread* head = atomic_load(&g_threads);
+    do {
+        thread->next = head;
+    } while (!atomic_compare_exchange_weak(&g_threads, &head, thread));
+
+#if defined(UG_PROFILE_THREADED)
+    // Without the key the ring just lives until exit, as on other platforms
+    pthread_once(&g_key_once, create_thread_key);
+    if (g_key_valid) {
+        pthread_setspecific(g_thread_key, thread);
+    }
+#endif
+
+    t_thread = thread;
+    return thread;
+}
+
+void ug_profile_zone_begin(const char* name) {
+    ProfileThread* thread = profile_thread();
+    if (!thread) {
+        return;
+    }
+
+    // Zones nested deeper than the tracked depth are counted but not recorded
+    if (thread->depth < PROFILE_MAX_DEPTH) {
+        thread->open_names[thread->depth] = name;
+        thread->open_starts[thread->depth] = ug_get_time_ns();
+    }
+    thread->depth++;
+}
+
+void ug_profile_zone_end(void) {
+    ProfileThread* thread = t_thread;
+    if (!thread || thread->depth == 0) {
+        return;
+    }
+
+    thread->depth--;
+    if (thread->depth >= PROFILE_MAX_DEPTH) {
+        return;
+    }
+
+    uint64_t end = ug_get_time_ns();
+    uint64_t start = thread->open_starts[thread->depth];
+    uint64_t head = atomic_load_explicit(&thread->head, memory_order_relaxed);
+    ProfileSlot* slot = &thread->events[head & (PROFILE_RING_SIZE - 1)];
+    // An exporter that reads any of these stores is guaranteed to see at least
+    // this head, which tells it the slot was being overwritten
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->name, thread->open_names[thread->depth], memory_order_relaxed);
+    atomic_store_explicit(&slot->start_ns, start, memory_order_relaxed);
+    atomic_store_explicit(&slot->duration_ns, end - start, memory_order_relaxed);
+    atomic_store_explicit(&thread->head, head + 1, memory_order_release);
+}
+
+// Copies the ring's latest events into out and returns how many survived.
+// Slots the owning thread overwrote (or may have been overwriting) while they
+// were copied are dropped from the front
+static size_t snapshot_thread(ProfileThread* thread, ProfileEvent* out) {
+    uint64_t head = atomic_load_explicit(&thread->head, memory_order_acquire);
+    uint64_t begin = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+
+    for (uint64_t i = begin; i < head; i++) {
+        const ProfileSlot* slot = &thread->events[i & (PROFILE_RING_SIZE - 1)];
+        ProfileEvent* event = &out[i - begin];
+        event->name = atomic_load_explicit(&slot->name, memory_order_relaxed);
+        event->start_ns = atomic_load_explicit(&slot->start_ns, memory_order_relaxed);
+        event->duration_ns = atomic_load_explicit(&slot->duration_ns, memory_order_relaxed);
+    }
+
+    // Writes at index w overwrite index w - PROFILE_RING_SIZE, and w can be
+    // one past the head seen here, so everything up to head - RING_SIZE is suspect
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t after = atomic_load_explicit(&thread->head, memory_order_relaxed);
+    uint64_t valid = after >= PROFILE_RING_SIZE ? after - PROFILE_RING_SIZE + 1 : 0;
+    if (valid <= begin) {
+        return (size_t)(head - begin);
+    }
+    if (valid >= head) {
+        return 0;
+    }
+    size_t dropped = (size_t)(valid - begin);
+    size_t kept = (size_t)(head - valid);
+    for (size_t i = 0; i < kept; i++) {
+        out[i] = out[dropped + i];
+    }
+    return kept;
+}
+
+// Zone names are string literals; escape the few characters JSON cares about
+static void write_json_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* p = text ? text : "?"; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        } else if ((unsigned char)*p < 0x20) {
+            fputc(' ', file);
+        } else {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool ug_profile_write_chrome_trace(const char* filepath) {
+    if (!filepath) {
+        return false;
+    }
+
+    ProfileEvent* events = (ProfileEvent*)malloc(PROFILE_RING_SIZE * sizeof(ProfileEvent));
+    if (!events) {
+        return false;
+    }
+
+    FILE* file = fopen(filepath, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to open trace file: %s\n", filepath);
+        free(events);
+        return false;
+    }
+
+#if defined(UG_PROFILE_THREADED)
+    pthread_mutex_lock(&g_export_lock);
+#endif
+
+    // Chrome trace "complete" events; timestamps are in microseconds
+    fputs("{\"traceEvents\":[\n", file);
+    bool first = true;
+    for (ProfileThread* thread = atomic_load(&g_threads); thread; thread = thread->next) {
+        size_t count = snapshot_thread(thread, events);
+        for (size_t i = 0; i < count; i++) {
+            const ProfileEvent* event = &events[i];
+            fputs(first ? "" : ",\n", file);
+            first = false;
+            fputs("{\"name\":", file);
+            write_json_string(file, event->name);
+            fprintf(file, ",\"cat\":\"ungrund\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    (double)event->start_ns * 1e-3, (double)event->duration_ns * 1e-3, thread->thread_id);
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+
+#if defined(UG_PROFILE_THREADED)
+    pthread_mutex_unlock(&g_export_lock);
+#endif
+    free(events);
+
+    bool ok = ferror(file) == 0;
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+#else
+
+bool ug_profile_write_chrome_trace(const char* filepath) {
+    (void)filepath;
+    return false;
+}
+
+#endif // UG_ENABLE_PROFILING
@@ -0,0 +1,269 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Recorded command sequence replayed inside render passes
+// The bundle remembers the link lists of the engine buffers it reads so
+// destroying one of them drops the recorded commands instead of leaving them dangling
+struct UGRenderBundle {
+    WGPURenderBundle bundle;        // NULL once invalidated
+    UGBundleLinks** dependencies;
+    size_t dependency_count;
+    uint32_t draw_count;
+};
+
+// Records commands into a WebGPU bundle encoder compatible with the context's passes
+struct UGRenderBundleBuilder {
+    WGPURenderBundleEncoder encoder;
+    UGRenderBundle* bundle;         // Collects dependencies until build hands it over
+    size_t dependency_capacity;
+};
+
+void ug_bundle_links_add(UGBundleLinks* links, UGRenderBundle* bundle) {
+    if (!links || !bundle) {
+        return;
+    }
+
+    if (links->count == links->capacity) {
+        size_t capacity = links->capacity ? links->capacity * 2 : 4;
+        UGRenderBundle** grown = (UGRenderBundle**)realloc(links->bundles, capacity * sizeof(UGRenderBundle*));
+        if (!grown) {
+            // An unlinked bundle would outlive the buffer, so drop it now
+            ug_render_bundle_invalidate(bundle);
+            return;
+        }
+        links->bundles = grown;
+        links->capacity = capacity;
+    }
+    links->bundles[links->count++] = bundle;
+}
+
+void ug_bundle_links_remove(UGBundleLinks* links, UGRenderBundle* bundle) {
+    if (!links) {
+        return;
+    }
+
+    for (size_t i = 0; i < links->count; i++) {
+        if (links->bundles[i] == bundle) {
+            links->bundles[i] = links->bundles[--links->count];
+            return;
+        }
+    }
+}
+
+void ug_bundle_links_release(UGBundleLinks* links) {
+    if (!links) {
+        return;
+    }
+
+    // Invalidating a bundle unlinks it from this list, shrinking it
+    while (links->count > 0) {
+        ug_render_bundle_invalidate(links->bundles[links->count - 1]);
+    }
+    free(links->bundles);
+    memset(links, 0, sizeof(*links));
+}
+
+static UGRenderBundleBuilder* create_builder(UGContext* context, WGPUTextureFormat depth_format) {
+    if (!context) {
+        return NULL;
+    }
+
+    UGRenderBundleBuilder* builder = (UGRenderBundleBuilder*)calloc(1, sizeof(UGRenderBundleBuilder));
+    if (!builder) {
+        return NULL;
+    }
+    builder->bundle = (UGRenderBundle*)calloc(1, sizeof(UGRenderBundle));
+    if (!builder->bundle) {
+        free(builder);
+        return NULL;
+    }
+
+    // Must match the attachments of the passes the bundle is replayed in
+    WGPUTextureFormat color_format = ug_context_get_surface_format(context);
+    WGPURenderBundleEncoderDescriptor desc = {
+        .colorFormatCount = 1,
+        .colorFormats = &color_format,
+        .depthStencilFormat = depth_format,
+        .sampleCount = ug_context_get_sample_count(context),
+    };
+    builder->encoder = wgpuDeviceCreateRenderBundleEncoder(ug_context_get_device(context), &desc);
+    if (!builder->encoder) {
+        free(builder->bundle);
+        free(builder);
+        return NULL;
+    }
+
+    return builder;
+}
+
+UGRenderBundleBuilder* ug_render_bundle_builder_create(UGContext* context) {
+    return create_builder(context, WGPUTextureFormat_Undefined);
+}
+
+UGRenderBundleBuilder* ug_render_bundle_builder_create_depth(UGContext* context) {
+    return create_builder(context, ug_context_get_depth_format(context));
+}
+
+void ug_render_bundle_builder_set_pipeline(UGRenderBundleBuilder* builder, WGPURenderPipeline pipeline) {
+    if (!builder || !builder->encoder || !pipeline) {
+        return;
+    }
+
+    wgpuRenderBundleEncoderSetPipeline(builder->encoder, pipeline);
+}
+
+void ug_render_bundle_builder_set_bind_group(UGRenderBundleBuilder* builder, uint32_t group_index,
+                                             WGPUBindGroup bind_group) {
+    if (!builder || !builder->encoder || !bind_group) {
+        return;
+    }
+
+    wgpuRenderBundleEncoderSetBindGroup(builder->encoder, group_index, bind_group, 0, NULL);
+}
+
+static bool add_dependency(UGRenderBundleBuilder* builder, UGBundleLinks* links) {
+    UGRenderBundle* bundle = builder->bundle;
+    for (size_t i = 0; i < bundle->dependency_count; i++) {
+        if (bundle->dependencies[i] == links) {
+            return true;
+        }
+    }
+
+    if (bundle->dependency_count == builder->dependency_capacity) {
+        size_t capacity = builder->dependency_capacity ? builder->dependency_capacity * 2 : 4;
+        UGBundleLinks** grown = (UGBundleLinks**)realloc(bundle->dependencies, capacity * sizeof(UGBundleLinks*));
+        if (!grown) {
+            return false;
+        }
+        bundle->dependencies = grown;
+        builder->dependency_capacity = capacity;
+    }
+    bundle->dependencies[bundle->dependency_count++] = links;
+    return true;
+}
+
+void ug_render_bundle_builder_set_vertex_buffer(UGRenderBundleBuilder* builder, uint32_t slot,
+                                                UGVertexBuffer* vertex_buffer, uint64_t offset) {
+    if (!builder || !builder->encoder || !vertex_buffer) {
+        return;
+    }
+
+    if (!add_dependency(builder, ug_vertex_buffer_get_bundle_links(vertex_buffer))) {
+        return;
+    }
+    wgpuRenderBundleEncoderSetVertexBuffer(builder->encoder, slot, ug_vertex_buffer_get_handle(vertex_buffer),
+                                           offset, WGPU_WHOLE_SIZE);
+}
+
+void ug_render_bundle_builder_set_index_buffer(UGRenderBundleBuilder* builder, UGIndexBuffer* index_buffer,
+                                               uint64_t offset) {
+    if (!builder || !builder->encoder || !index_buffer) {
+        return;
+    }
+
+    if (!add_dependency(builder, ug_index_buffer_get_bundle_links(index_buffer))) {
+        return;
+    }
+    wgpuRenderBundleEncoderSetIndexBuffer(builder->encoder, ug_index_buffer_get_handle(index_buffer),
+                                          ug_index_buffer_get_format(index_buffer), offset, WGPU_WHOLE_SIZE);
+}
+
+void ug_render_bundle_builder_draw(UGRenderBundleBuilder* builder, uint32_t first_vertex, uint32_t vertex_count) {
+    if (!builder || !builder->encoder || vertex_count == 0) {
+        return;
+    }
+
+    wgpuRenderBundleEncoderDraw(builder->encoder, vertex_count, 1, first_vertex, 0);
+    builder->bundle->draw_count++;
+}
+
+void ug_render_bundle_builder_draw_indexed(UGRenderBundleBuilder* builder, uint32_t first_index,
+                                           uint32_t index_count, int32_t base_vertex) {
+    if (!builder || !builder->encoder || index_count == 0) {
+        return;
+    }
+
+    wgpuRenderBundleEncoderDrawIndexed(builder->encoder, index_count, 1, first_index, base_vertex, 0);
+    builder->bundle->draw_count++;
+}
+
+UGRenderBundle* ug_render_bundle_builder_build(UGRenderBundleBuilder* builder) {
+    if (!builder || !builder->encoder) {
+        return NULL;
+    }
+
+    UGRenderBundle* bundle = builder->bundle;
+    bundle->bundle = wgpuRenderBundleEncoderFinish(builder->encoder, NULL);
+    wgpuRenderBundleEncoderRelease(builder->encoder);
+    builder->encoder = NULL;
+    builder->bundle = NULL;
+
+    if (!bundle->bundle) {
+        free(bundle->dependencies);
+        free(bundle);
+        return NULL;
+    }
+
+    // Only register once the bundle exists, so a failed build leaves no links behind
+    for (size_t i = 0; i < bundle->dependency_count; i++) {
+        ug_bundle_links_add(bundle->dependencies[i], bundle);
+    }
+
+    return bundle;
+}
+
+void ug_render_bundle_builder_destroy(UGRenderBundleBuilder* builder) {
+    if (!builder) {
+        return;
+    }
+
+    if (builder->encoder) {
+        wgpuRenderBundleEncoderRelease(builder->encoder);
+    }
+    if (builder->bundle) {
+        free(builder->bundle->dependencies);
+        free(builder->bundle);
+    }
+    free(builder);
+}
+
+void ug_render_bundle_invalidate(UGRenderBundle* bundle) {
+    if (!bundle) {
+        return;
+    }
+
+    for (size_t i = 0; i < bundle->dependency_count; i++) {
+        ug_bundle_links_remove(bundle->dependencies[i], bundle);
+    }
+    bundle->dependency_count = 0;
+
+    if (bundle->bundle) {
+        wgpuRenderBundleRelease(bundle->bundle);
+        bundle->bundle = NULL;
+    }
+}
+
+bool ug_render_bundle_is_valid(UGRenderBundle* bundle) {
+    return bundle && bundle->bundle;
+}
+
+WGPURenderBundle ug_render_bundle_get_handle(UGRenderBundle* bundle) {
+    return bundle ? bundle->bundle : NULL;
+}
+
+uint32_t ug_render_bundle_get_draw_count(UGRenderBundle* bundle) {
+    return bundle ? bundle->draw_count : 0;
+}
+
+void ug_render_bundle_destroy(UGRenderBundle* bundle) {
+    if (!bundle) {
+        return;
+    }
+
+    ug_render_bundle_invalidate(bundle);
+    free(bundle->dependencies);
+    free(bundle);
+}
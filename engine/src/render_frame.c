@@ -1,56 +1,198 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+// A frame slot. The ring preallocates one per frame in flight and recycles
+// them in order, so the steady-state render loop never touches the heap.
 struct UGRenderFrame {
     UGContext* context;
+    uint32_t index;                 // Slot index within the ring
+    uint64_t number;                // Frame number currently (or last) using this slot
     WGPUSurfaceTexture surface_texture;
     WGPUTextureView view;
     WGPUCommandEncoder encoder;
+    WGPUCommandEncoder upload_encoder;  // Submitted first; NULL until used this frame
+
+    UGRenderPass* pass;             // Preallocated pass object reused every frame
+    bool pass_in_use;
+
+    // Secondary encoders handed out this frame; allocated on first use and kept
+    UGCommandList* command_lists[UG_MAX_COMMAND_LISTS];
+    uint32_t command_list_count;
+
+    UGFrameArena arena;             // Transient CPU memory, reset at end of frame
+    uint64_t record_start_ns;       // When the frame was handed to the caller
+    UGJobCounter* jobs;             // Jobs that must finish before submit
+
+    // Completion fence: set on submit, cleared by wgpuQueueOnSubmittedWorkDone
+    atomic_bool gpu_busy;
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    WGPUSubmissionIndex submission;
+#endif
 };
 
-UGRenderFrame* ug_begin_render_frame(UGContext* context) {
-    if (!context) {
+struct UGFrameRing {
+    UGContext* context;
+    UGRenderFrame* slots;
+    uint32_t slot_count;
+    uint64_t next_frame;            // Number of the next frame to begin
+};
+
+UGFrameRing* ug_frame_ring_create(UGContext* context, uint32_t slot_count) {
+    if (!context || slot_count == 0) {
         return NULL;
     }
 
-    UGRenderFrame* frame = (UGRenderFrame*)calloc(1, sizeof(UGRenderFrame));
-    if (!frame) {
+    UGFrameRing* ring = (UGFrameRing*)calloc(1, sizeof(UGFrameRing));
+    if (!ring) {
+        return NULL;
+    }
+
+    ring->slots = (UGRenderFrame*)calloc(slot_count, sizeof(UGRenderFrame));
+    if (!ring->slots) {
+        free(ring);
         return NULL;
     }
 
-    frame->context = context;
+    ring->context = context;
+    ring->slot_count = slot_count;
 
-    // Get current surface texture
-    WGPUSurface surface = ug_context_get_surface(context);
-    wgpuSurfaceGetCurrentTexture(surface, &frame->surface_texture);
+    for (uint32_t i = 0; i < slot_count; i++) {
+        UGRenderFrame* slot = &ring->slots[i];
+        slot->context = context;
+        slot->index = i;
+        atomic_init(&slot->gpu_busy, false);
+        ug_frame_arena_init(&slot->arena, UG_FRAME_ARENA_DEFAULT_CHUNK_SIZE);
 
-    if (frame->surface_texture.status != WGPUSurfaceGetCurrentTextureStatus_SuccessOptimal &&
-        frame->surface_texture.status != WGPUSurfaceGetCurrentTextureStatus_SuccessSuboptimal) {
-        fprintf(stderr, "Failed to get surface texture: %d\n", frame->surface_texture.status);
-        free(frame);
-        return NULL;
+        slot->pass = ug_render_pass_alloc();
+        slot->jobs = ug_job_counter_create();
+        if (!slot->pass || !slot->jobs) {
+            ug_frame_ring_destroy(ring);
+            return NULL;
+        }
     }
 
-    // Create texture view
-    frame->view = wgpuTextureCreateView(frame->surface_texture.texture, NULL);
-    if (!frame->view) {
-        fprintf(stderr, "Failed to create texture view\n");
-        free(frame);
+    return ring;
+}
+
+void ug_frame_ring_destroy(UGFrameRing* ring) {
+    if (!ring) {
+        return;
+    }
+
+    // Callers wait for the GPU before destroying, so no fence callback can
+    // still be pointing at a slot
+    for (uint32_t i = 0; i < ring->slot_count; i++) {
+        ug_render_pass_free(ring->slots[i].pass);
+        for (uint32_t j = 0; j < UG_MAX_COMMAND_LISTS; j++) {
+            ug_command_list_free(ring->slots[i].command_lists[j]);
+        }
+        ug_job_counter_destroy(ring->slots[i].jobs);
+        ug_frame_arena_release(&ring->slots[i].arena);
+    }
+    free(ring->slots);
+    free(ring);
+}
+
+// Fence callback fired once the GPU has finished the slot's submission
+static void on_frame_work_done(WGPUQueueWorkDoneStatus status, void* userdata1, void* userdata2) {
+    (void)status;
+    (void)userdata2;
+    UGRenderFrame* slot = (UGRenderFrame*)userdata1;
+    atomic_store(&slot->gpu_busy, false);
+}
+
+// Block until the GPU is done with everything the slot submitted last time around
+static void wait_for_slot(UGRenderFrame* slot) {
+    while (atomic_load(&slot->gpu_busy)) {
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+        wgpuDevicePoll(ug_context_get_device(slot->context), true, &slot->submission);
+#else
+        ug_context_poll(slot->context, true);
+#endif
+    }
+}
+
+static UGRenderFrame* begin_render_frame(UGContext* context) {
+    UGFrameRing* ring = ug_context_get_frame_ring(context);
+    if (!ring) {
         return NULL;
     }
+    UGFrameStatsWindow* stats = ug_context_get_frame_stats_window(context);
+    uint64_t begin_ns = ug_get_time_ns();
+
+    UGRenderFrame* frame = &ring->slots[ring->next_frame % ring->slot_count];
+
+    // The slot's resources may only be recycled once the GPU has finished with them
+    UG_PROFILE_BEGIN("wait_for_slot");
+    wait_for_slot(frame);
+    UG_PROFILE_END();
+
+    frame->pass_in_use = false;
+    frame->command_list_count = 0;
+    frame->surface_texture = (WGPUSurfaceTexture){0};
+
+    if (ug_context_is_headless(context)) {
+        // Headless contexts render into the engine-owned offscreen texture
+        frame->view = ug_context_get_offscreen_view(context);
+    } else {
+        // Get current surface texture
+        WGPUSurface surface = ug_context_get_surface(context);
+        UG_PROFILE_BEGIN("acquire_surface_texture");
+        uint64_t acquire_start = ug_get_time_ns();
+        wgpuSurfaceGetCurrentTexture(surface, &frame->surface_texture);
+        ug_frame_stats_add_timing(stats, UG_FRAME_TIMING_ACQUIRE, ug_get_time_ns() - acquire_start);
+        UG_PROFILE_END();
+
+        if (frame->surface_texture.status != WGPUSurfaceGetCurrentTextureStatus_SuccessOptimal &&
+            frame->surface_texture.status != WGPUSurfaceGetCurrentTextureStatus_SuccessSuboptimal) {
+            fprintf(stderr, "Failed to get surface texture: %d\n", frame->surface_texture.status);
+            if (frame->surface_texture.texture) {
+                wgpuTextureRelease(frame->surface_texture.texture);
+            }
+            return NULL;
+        }
+
+        ug_context_set_target_size(context, wgpuTextureGetWidth(frame->surface_texture.texture),
+                                   wgpuTextureGetHeight(frame->surface_texture.texture));
+
+        // Create texture view
+        frame->view = wgpuTextureCreateView(frame->surface_texture.texture, NULL);
+        if (!frame->view) {
+            fprintf(stderr, "Failed to create texture view\n");
+            wgpuTextureRelease(frame->surface_texture.texture);
+            return NULL;
+        }
+    }
 
     // Create command encoder
     WGPUDevice device = ug_context_get_device(context);
     frame->encoder = wgpuDeviceCreateCommandEncoder(device, NULL);
     if (!frame->encoder) {
         fprintf(stderr, "Failed to create command encoder\n");
-        wgpuTextureViewRelease(frame->view);
-        free(frame);
+        if (frame->surface_texture.texture) {
+            wgpuTextureViewRelease(frame->view);
+            wgpuTextureRelease(frame->surface_texture.texture);
+        }
         return NULL;
     }
 
+    // Publishes the timings this slot collected last time around
+    ug_gpu_profiler_begin_frame(ug_context_get_gpu_profiler(context), frame->index, ring->next_frame);
+
+    frame->number = ring->next_frame++;
+    ug_frame_stats_begin_frame(stats, begin_ns);
+    frame->record_start_ns = ug_get_time_ns();
+    return frame;
+}
+
+UGRenderFrame* ug_begin_render_frame(UGContext* context) {
+    UG_PROFILE_BEGIN("ug_begin_render_frame");
+    UGRenderFrame* frame = begin_render_frame(context);
+    UG_PROFILE_END();
     return frame;
 }
 
@@ -62,26 +204,200 @@ WGPUCommandEncoder ug_render_frame_get_encoder(UGRenderFrame* frame) {
     return frame ? frame->encoder : NULL;
 }
 
+WGPUCommandEncoder ug_render_frame_get_upload_encoder(UGRenderFrame* frame) {
+    if (!frame || !frame->encoder) {
+        return NULL;
+    }
+    if (!frame->upload_encoder) {
+        WGPUCommandEncoderDescriptor encoder_desc = {
+            .label = {"Frame Upload Encoder", WGPU_STRLEN},
+        };
+        frame->upload_encoder = wgpuDeviceCreateCommandEncoder(ug_context_get_device(frame->context), &encoder_desc);
+        if (!frame->upload_encoder) {
+            fprintf(stderr, "Failed to create upload command encoder\n");
+        }
+    }
+    return frame->upload_encoder;
+}
+
+UGContext* ug_render_frame_get_context(UGRenderFrame* frame) {
+    return frame ? frame->context : NULL;
+}
+
+UGJobCounter* ug_render_frame_get_job_counter(UGRenderFrame* frame) {
+    return frame ? frame->jobs : NULL;
+}
+
+uint32_t ug_render_frame_get_index(UGRenderFrame* frame) {
+    return frame ? frame->index : 0;
+}
+
+uint64_t ug_render_frame_get_number(UGRenderFrame* frame) {
+    return frame ? frame->number : 0;
+}
+
+void* ug_frame_alloc(UGRenderFrame* frame, size_t size, size_t align) {
+    if (!frame) {
+        return NULL;
+    }
+    return ug_frame_arena_alloc(&frame->arena, size, align);
+}
+
+UGRenderPass* ug_render_frame_acquire_pass(UGRenderFrame* frame) {
+    if (!frame || frame->pass_in_use) {
+        fprintf(stderr, "Only one render pass can be open per frame at a time\n");
+        return NULL;
+    }
+
+    frame->pass_in_use = true;
+    return frame->pass;
+}
+
+void ug_render_frame_release_pass(UGRenderFrame* frame, UGRenderPass* pass) {
+    if (frame && frame->pass == pass) {
+        frame->pass_in_use = false;
+    }
+}
+
+static UGCommandList* create_command_list(UGRenderFrame* frame, int32_t order, bool depth) {
+    if (!frame || !frame->encoder) {
+        return NULL;
+    }
+    if (frame->command_list_count == UG_MAX_COMMAND_LISTS) {
+        fprintf(stderr, "At most %d command lists per frame\n", UG_MAX_COMMAND_LISTS);
+        return NULL;
+    }
+
+    UGCommandList** slot = &frame->command_lists[frame->command_list_count];
+    if (!*slot) {
+        *slot = ug_command_list_alloc();
+        if (!*slot) {
+            return NULL;
+        }
+    }
+    if (!ug_command_list_begin(*slot, frame, order, depth)) {
+        return NULL;
+    }
+
+    frame->command_list_count++;
+    return *slot;
+}
+
+UGCommandList* ug_render_frame_create_command_list(UGRenderFrame* frame, int32_t order) {
+    return create_command_list(frame, order, false);
+}
+
+UGCommandList* ug_render_frame_create_depth_command_list(UGRenderFrame* frame, int32_t order) {
+    return create_command_list(frame, order, true);
+}
+
+// Finish the frame's encoders and command lists into out_commands in submission
+// order: uploads, lists with a negative order, the frame's own commands, the
+// rest. Lists with equal order keep their creation order. Returns the buffer count
+static uint32_t finish_commands(UGRenderFrame* frame, WGPUCommandBuffer* out_commands) {
+    UGCommandList* sorted[UG_MAX_COMMAND_LISTS];
+    uint32_t count = frame->command_list_count;
+    for (uint32_t i = 0; i < count; i++) {
+        UGCommandList* list = frame->command_lists[i];
+        int32_t order = ug_command_list_get_order(list);
+        uint32_t j = i;
+        while (j > 0 && ug_command_list_get_order(sorted[j - 1]) > order) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = list;
+    }
+
+    UGFrameCounters* counters = ug_context_get_frame_counters(frame->context);
+    uint32_t command_count = 0;
+    uint32_t next = 0;
+    if (frame->upload_encoder) {
+        out_commands[command_count++] = wgpuCommandEncoderFinish(frame->upload_encoder, NULL);
+    }
+    while (next < count && ug_command_list_get_order(sorted[next]) < 0) {
+        out_commands[command_count++] = ug_command_list_finish(sorted[next++], counters);
+    }
+    out_commands[command_count++] = wgpuCommandEncoderFinish(frame->encoder, NULL);
+    while (next < count) {
+        out_commands[command_count++] = ug_command_list_finish(sorted[next++], counters);
+    }
+
+    frame->command_list_count = 0;
+    return command_count;
+}
+
 void ug_end_render_frame(UGRenderFrame* frame) {
     if (!frame) {
         return;
     }
 
-    // Finish command encoder
-    WGPUCommandBuffer command = wgpuCommandEncoderFinish(frame->encoder, NULL);
+    UG_PROFILE_BEGIN("ug_end_render_frame");
 
-    // Submit to queue
+    // Work the frame kicked off may still be producing data it consumes
+    UG_PROFILE_BEGIN("wait_frame_jobs");
+    ug_jobs_wait(ug_context_get_job_system(frame->context), frame->jobs);
+    UG_PROFILE_END();
+
+    UGFrameStatsWindow* stats = ug_context_get_frame_stats_window(frame->context);
+    uint64_t submit_start = ug_get_time_ns();
+    ug_frame_stats_add_timing(stats, UG_FRAME_TIMING_CPU, submit_start - frame->record_start_ns);
+
+    UGGpuProfiler* profiler = ug_context_get_gpu_profiler(frame->context);
+    ug_gpu_profiler_resolve(profiler, frame->index, frame->encoder);
+
+    // Finish the frame's encoder and every command list recorded for it
+    WGPUCommandBuffer commands[UG_MAX_COMMAND_LISTS + 2];
+    uint32_t command_count = finish_commands(frame, commands);
+
+    // Submit to queue and arm the slot's fence
+    UG_PROFILE_BEGIN("submit");
     WGPUQueue queue = ug_context_get_queue(frame->context);
-    wgpuQueueSubmit(queue, 1, &command);
+    atomic_store(&frame->gpu_busy, true);
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    frame->submission = wgpuQueueSubmitForIndex(queue, command_count, commands);
+#else
+    wgpuQueueSubmit(queue, command_count, commands);
+#endif
+
+    WGPUQueueWorkDoneCallbackInfo fence_info = {
+        .mode = WGPUCallbackMode_AllowSpontaneous,
+        .callback = on_frame_work_done,
+        .userdata1 = frame,
+    };
+    wgpuQueueOnSubmittedWorkDone(queue, fence_info);
+    ug_gpu_profiler_after_submit(profiler, frame->index);
+    ug_frame_stats_add_timing(stats, UG_FRAME_TIMING_SUBMIT, ug_get_time_ns() - submit_start);
+    UG_PROFILE_END();
 
-    // Present surface
-    WGPUSurface surface = ug_context_get_surface(frame->context);
-    wgpuSurfacePresent(surface);
+    // Present surface (headless frames stay in the offscreen texture)
+    if (!ug_context_is_headless(frame->context)) {
+        WGPUSurface surface = ug_context_get_surface(frame->context);
+        UG_PROFILE_BEGIN("present");
+        uint64_t present_start = ug_get_time_ns();
+        wgpuSurfacePresent(surface);
+        ug_frame_stats_add_timing(stats, UG_FRAME_TIMING_PRESENT, ug_get_time_ns() - present_start);
+        UG_PROFILE_END();
+    }
 
-    // Cleanup
-    wgpuCommandBufferRelease(command);
+    // Cleanup - the slot itself stays in the ring for reuse
+    for (uint32_t i = 0; i < command_count; i++) {
+        wgpuCommandBufferRelease(commands[i]);
+    }
     wgpuCommandEncoderRelease(frame->encoder);
-    wgpuTextureViewRelease(frame->view);
-    free(frame);
-}
+    frame->encoder = NULL;
+    if (frame->upload_encoder) {
+        wgpuCommandEncoderRelease(frame->upload_encoder);
+        frame->upload_encoder = NULL;
+    }
+    if (frame->surface_texture.texture) {
+        wgpuTextureViewRelease(frame->view);
+        wgpuTextureRelease(frame->surface_texture.texture);
+        frame->surface_texture.texture = NULL;
+    }
+    frame->view = NULL;
 
+    // Everything handed out by ug_frame_alloc this frame is released in bulk
+    ug_frame_arena_reset(&frame->arena);
+    ug_frame_stats_end_frame(stats);
+    UG_PROFILE_END();
+}
@@ -0,0 +1,547 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Passes and textures are declared into fixed arrays every frame, so declaring
+// a graph never allocates. Dependencies follow declaration order:
+// a read sees the latest earlier write of the texture, and a write must wait
+// for earlier readers and writers. Execution walks backwards from the
+// backbuffer and imported textures to cull passes nothing depends on, then
+// schedules the survivors. Transient textures come from a pool; two transients
+// with the same size and format share one GPU texture when their lifetimes in
+// the scheduled order do not overlap. WebGPU has no placed resources, so
+// sharing a texture is how memory is aliased.
+
+#define NO_PASS UINT32_MAX
+
+// Pool textures unused for this many executes are released
+#define POOL_KEEP_EXECUTES 8
+
+typedef enum {
+    TEXTURE_BACKBUFFER,
+    TEXTURE_IMPORTED,
+    TEXTURE_TRANSIENT,
+} UGGraphTextureKind;
+
+typedef struct {
+    const char* name;
+    UGGraphTextureKind kind;
+    uint32_t width;
+    uint32_t height;
+    WGPUTextureFormat format;
+    WGPUTextureView view;       // Imported view, or the pool view assigned at execute
+    uint32_t last_writer;       // Declaration-time tracking
+    uint32_t first_use;         // Position in the execution order
+    uint32_t last_use;
+} UGGraphTexture;
+
+typedef struct {
+    const char* name;
+    UGRenderGraphPassCallback callback;
+    void* userdata;
+    UGRenderGraphTexture target;
+    bool clear;
+    float clear_color[4];
+    UGRenderGraphTexture reads[UG_RENDER_GRAPH_MAX_READS];
+    uint32_t read_count;
+
+    // Earlier passes this one must run after; data dependencies also keep them alive
+    uint32_t deps[UG_RENDER_GRAPH_MAX_PASSES];
+    bool dep_is_data[UG_RENDER_GRAPH_MAX_PASSES];
+    uint32_t dep_count;
+    bool needed;
+    bool scheduled;
+} UGGraphPass;
+
+typedef struct {
+    WGPUTexture texture;
+    WGPUTextureView view;
+    uint32_t width;
+    uint32_t height;
+    WGPUTextureFormat format;
+    uint32_t busy_until;        // Execution position of the current holder's last use
+    bool taken;                 // Assigned during the current execute
+    uint64_t last_execute;
+} UGPoolTexture;
+
+struct UGRenderGraph {
+    UGContext* context;
+    UGRenderFrame* frame;
+    uint64_t execute_count;
+
+    UGGraphPass passes[UG_RENDER_GRAPH_MAX_PASSES];
+    uint32_t pass_count;
+    UGGraphTexture textures[UG_RENDER_GRAPH_MAX_TEXTURES];
+    uint32_t texture_count;
+    uint32_t order[UG_RENDER_GRAPH_MAX_PASSES];
+    uint32_t order_count;
+    bool failed;                // A declaration overflowed or was invalid this frame
+
+    UGPoolTexture pool[UG_RENDER_GRAPH_MAX_TEXTURES];
+    uint32_t pool_count;
+};
+
+UGRenderGraph* ug_render_graph_create(UGContext* context) {
+    if (!context) {
+        return NULL;
+    }
+
+    UGRenderGraph* graph = (UGRenderGraph*)calloc(1, sizeof(UGRenderGraph));
+    if (!graph) {
+        return NULL;
+    }
+    graph->context = context;
+    return graph;
+}
+
+static void release_pool_texture(UGPoolTexture* entry) {
+    if (entry->view) {
+        wgpuTextureViewRelease(entry->view);
+    }
+    if (entry->texture) {
+        wgpuTextureRelease(entry->texture);
+    }
+    memset(entry, 0, sizeof(*entry));
+}
+
+void ug_render_graph_destroy(UGRenderGraph* graph) {
+    if (!graph) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < graph->pool_count; i++) {
+        release_pool_texture(&graph->pool[i]);
+    }
+    free(graph);
+}
+
+void ug_render_graph_begin(UGRenderGraph* graph, UGRenderFrame* frame) {
+    if (!graph) {
+        return;
+    }
+
+    graph->frame = frame;
+    graph->pass_count = 0;
+    graph->order_count = 0;
+    graph->failed = false;
+
+    // Handle 0 is always the frame's own view
+    UGGraphTexture* backbuffer = &graph->textures[0];
+    memset(backbuffer, 0, sizeof(*backbuffer));
+    backbuffer->name = "backbuffer";
+    backbuffer->kind = TEXTURE_BACKBUFFER;
+    backbuffer->view = frame ? ug_render_frame_get_view(frame) : NULL;
+    backbuffer->last_writer = NO_PASS;
+    graph->texture_count = 1;
+}
+
+UGRenderFrame* ug_render_graph_get_frame(UGRenderGraph* graph) {
+    return graph ? graph->frame : NULL;
+}
+
+static UGRenderGraphTexture add_texture(UGRenderGraph* graph, const char* name, UGGraphTextureKind kind) {
+    if (graph->texture_count >= UG_RENDER_GRAPH_MAX_TEXTURES) {
+        fprintf(stderr, "Render graph: too many textures (max %d)\n", UG_RENDER_GRAPH_MAX_TEXTURES);
+        graph->failed = true;
+        return UG_RENDER_GRAPH_INVALID;
+    }
+
+    UGRenderGraphTexture handle = graph->texture_count++;
+    UGGraphTexture* texture = &graph->textures[handle];
+    memset(texture, 0, sizeof(*texture));
+    texture->name = name;
+    texture->kind = kind;
+    texture->last_writer = NO_PASS;
+    return handle;
+}
+
+UGRenderGraphTexture ug_render_graph_create_texture(UGRenderGraph* graph, const char* name,
+                                                    uint32_t width, uint32_t height, WGPUTextureFormat format) {
+    if (!graph) {
+        return UG_RENDER_GRAPH_INVALID;
+    }
+
+    UGRenderGraphTexture handle = add_texture(graph, name, TEXTURE_TRANSIENT);
+    if (handle == UG_RENDER_GRAPH_INVALID) {
+        return handle;
+    }
+
+    UGGraphTexture* texture = &graph->textures[handle];
+    if (width == 0 || height == 0) {
+        ug_context_get_surface_size(graph->context, &width, &height);
+    }
+    texture->width = width;
+    texture->height = height;
+    texture->format = format == WGPUTextureFormat_Undefined ? ug_context_get_surface_format(graph->context) : format;
+    return handle;
+}
+
+UGRenderGraphTexture ug_render_graph_import_texture(UGRenderGraph* graph, const char* name, WGPUTextureView view) {
+    if (!graph || !view) {
+        return UG_RENDER_GRAPH_INVALID;
+    }
+
+    UGRenderGraphTexture handle = add_texture(graph, name, TEXTURE_IMPORTED);
+    if (handle != UG_RENDER_GRAPH_INVALID) {
+        graph->textures[handle].view = view;
+    }
+    return handle;
+}
+
+// Dependencies are always earlier passes, so the list can't outgrow the pass count
+static void add_dependency(UGGraphPass* pass, uint32_t dependency, bool is_data) {
+    if (dependency == NO_PASS) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < pass->dep_count; i++) {
+        if (pass->deps[i] == dependency) {
+            pass->dep_is_data[i] = pass->dep_is_data[i] || is_data;
+            return;
+        }
+    }
+
+    pass->deps[pass->dep_count] = dependency;
+    pass->dep_is_data[pass->dep_count] = is_data;
+    pass->dep_count++;
+}
+
+UGRenderGraphPass ug_render_graph_add_pass(UGRenderGraph* graph, const char* name,
+                                           UGRenderGraphPassCallback callback, void* userdata) {
+    if (!graph || !callback) {
+        return UG_RENDER_GRAPH_INVALID;
+    }
+    if (graph->pass_count >= UG_RENDER_GRAPH_MAX_PASSES) {
+        fprintf(stderr, "Render graph: too many passes (max %d)\n", UG_RENDER_GRAPH_MAX_PASSES);
+        graph->failed = true;
+        return UG_RENDER_GRAPH_INVALID;
+    }
+
+    UGRenderGraphPass handle = graph->pass_count++;
+    UGGraphPass* pass = &graph->passes[handle];
+    memset(pass, 0, sizeof(*pass));
+    pass->name = name;
+    pass->callback = callback;
+    pass->userdata = userdata;
+    pass->target = UG_RENDER_GRAPH_INVALID;
+    return handle;
+}
+
+static UGGraphPass* get_pass(UGRenderGraph* graph, UGRenderGraphPass pass) {
+    if (!graph || pass >= graph->pass_count) {
+        return NULL;
+    }
+    return &graph->passes[pass];
+}
+
+static bool valid_texture(UGRenderGraph* graph, UGRenderGraphTexture texture) {
+    return texture < graph->texture_count;
+}
+
+void ug_render_graph_pass_read(UGRenderGraph* graph, UGRenderGraphPass pass_handle, UGRenderGraphTexture texture) {
+    UGGraphPass* pass = get_pass(graph, pass_handle);
+    if (!pass || !valid_texture(graph, texture)) {
+        return;
+    }
+
+    // The surface texture is a render attachment only and can't be sampled, a
+    // pass can't sample its own target, and a transient has no contents until written
+    UGGraphTexture* source = &graph->textures[texture];
+    if (source->kind == TEXTURE_BACKBUFFER || pass->target == texture ||
+        (source->kind == TEXTURE_TRANSIENT && source->last_writer == NO_PASS) ||
+        pass->read_count >= UG_RENDER_GRAPH_MAX_READS) {
+        fprintf(stderr, "Render graph: pass '%s' cannot read '%s'\n", pass->name, source->name);
+        graph->failed = true;
+        return;
+    }
+
+    pass->reads[pass->read_count++] = texture;
+    add_dependency(pass, graph->textures[texture].last_writer, true);
+}
+
+static void set_target(UGRenderGraph* graph, UGRenderGraphPass pass_handle, UGRenderGraphTexture texture,
+                       bool clear, float r, float g, float b, float a) {
+    UGGraphPass* pass = get_pass(graph, pass_handle);
+    if (!pass || !valid_texture(graph, texture)) {
+        return;
+    }
+    if (pass->target != UG_RENDER_GRAPH_INVALID) {
+        fprintf(stderr, "Render graph: pass '%s' already has a target\n", pass->name);
+        graph->failed = true;
+        return;
+    }
+    for (uint32_t i = 0; i < pass->read_count; i++) {
+        if (pass->reads[i] == texture) {
+            fprintf(stderr, "Render graph: pass '%s' cannot write '%s' while reading it\n",
+                    pass->name, graph->textures[texture].name);
+            graph->failed = true;
+            return;
+        }
+    }
+
+    pass->target = texture;
+    pass->clear = clear;
+    pass->clear_color[0] = r;
+    pass->clear_color[1] = g;
+    pass->clear_color[2] = b;
+    pass->clear_color[3] = a;
+
+    // Loading keeps the previous contents, so the previous writer is a data
+    // dependency; after a clear it only has to run first
+    UGGraphTexture* target = &graph->textures[texture];
+    add_dependency(pass, target->last_writer, !clear);
+
+    // Anyone who read the previous contents must run before they are overwritten
+    for (uint32_t i = 0; i < pass_handle; i++) {
+        UGGraphPass* earlier = &graph->passes[i];
+        for (uint32_t j = 0; j < earlier->read_count; j++) {
+            if (earlier->reads[j] == texture && (target->last_writer == NO_PASS || i > target->last_writer)) {
+                add_dependency(pass, i, false);
+                break;
+            }
+        }
+    }
+
+    target->last_writer = pass_handle;
+}
+
+void ug_render_graph_pass_write(UGRenderGraph* graph, UGRenderGraphPass pass, UGRenderGraphTexture texture) {
+    set_target(graph, pass, texture, false, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void ug_render_graph_pass_clear(UGRenderGraph* graph, UGRenderGraphPass pass, UGRenderGraphTexture texture,
+                                float r, float g, float b, float a) {
+    set_target(graph, pass, texture, true, r, g, b, a);
+}
+
+static void mark_needed(UGRenderGraph* graph, uint32_t pass_index) {
+    if (pass_index == NO_PASS || graph->passes[pass_index].needed) {
+        return;
+    }
+
+    UGGraphPass* pass = &graph->passes[pass_index];
+    pass->needed = true;
+    for (uint32_t i = 0; i < pass->dep_count; i++) {
+        if (pass->dep_is_data[i]) {
+            mark_needed(graph, pass->deps[i]);
+        }
+    }
+}
+
+static bool depends_on(const UGGraphPass* pass, uint32_t other, bool data_only) {
+    for (uint32_t i = 0; i < pass->dep_count; i++) {
+        if (pass->deps[i] == other && (!data_only || pass->dep_is_data[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_ready(UGRenderGraph* graph, const UGGraphPass* pass) {
+    for (uint32_t i = 0; i < pass->dep_count; i++) {
+        const UGGraphPass* dep = &graph->passes[pass->deps[i]];
+        if (dep->needed && !dep->scheduled) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Topological order over the needed passes. Among ready passes, prefer one
+// that consumes the output of the pass just scheduled so intermediates die
+// early and free their pool texture for the next one; otherwise keep
+// declaration order
+static void schedule(UGRenderGraph* graph) {
+    uint32_t previous = NO_PASS;
+    for (;;) {
+        uint32_t pick = NO_PASS;
+        for (uint32_t i = 0; i < graph->pass_count; i++) {
+            UGGraphPass* pass = &graph->passes[i];
+            if (!pass->needed || pass->scheduled || !is_ready(graph, pass)) {
+                continue;
+            }
+            if (previous != NO_PASS && depends_on(pass, previous, true)) {
+                pick = i;
+                break;
+            }
+            if (pick == NO_PASS) {
+                pick = i;
+            }
+        }
+        if (pick == NO_PASS) {
+            return;
+        }
+
+        graph->passes[pick].scheduled = true;
+        graph->order[graph->order_count++] = pick;
+        previous = pick;
+    }
+}
+
+static void touch_texture(UGGraphTexture* texture, uint32_t position) {
+    if (texture->first_use == NO_PASS) {
+        texture->first_use = position;
+    }
+    texture->last_use = position;
+}
+
+// Greedy interval assignment: transients in order of first use take any free
+// pool texture of the same size and format, or a new one
+static bool assign_transients(UGRenderGraph* graph) {
+    for (uint32_t i = 0; i < graph->pool_count; i++) {
+        graph->pool[i].taken = false;
+    }
+
+    for (uint32_t position = 0; position < graph->order_count; position++) {
+        for (uint32_t t = 0; t < graph->texture_count; t++) {
+            UGGraphTexture* texture = &graph->textures[t];
+            if (texture->kind != TEXTURE_TRANSIENT || texture->first_use != position) {
+                continue;
+            }
+
+            UGPoolTexture* match = NULL;
+            for (uint32_t p = 0; p < graph->pool_count; p++) {
+                UGPoolTexture* entry = &graph->pool[p];
+                if (entry->width == texture->width && entry->height == texture->height &&
+                    entry->format == texture->format && (!entry->taken || entry->busy_until < position)) {
+                    match = entry;
+                    break;
+                }
+            }
+
+            if (!match) {
+                if (graph->pool_count >= UG_RENDER_GRAPH_MAX_TEXTURES) {
+                    fprintf(stderr, "Render graph: transient texture pool exhausted\n");
+                    return false;
+                }
+                match = &graph->pool[graph->pool_count++];
+                WGPUTextureDescriptor desc = {
+                    .label = {"Render Graph Transient", WGPU_STRLEN},
+                    .usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding,
+                    .dimension = WGPUTextureDimension_2D,
+                    .size = {texture->width, texture->height, 1},
+                    .format = texture->format,
+                    .mipLevelCount = 1,
+                    .sampleCount = 1,
+                };
+                match->texture = wgpuDeviceCreateTexture(ug_context_get_device(graph->context), &desc);
+                match->view = match->texture ? wgpuTextureCreateView(match->texture, NULL) : NULL;
+                match->width = texture->width;
+                match->height = texture->height;
+                match->format = texture->format;
+                if (!match->view) {
+                    fprintf(stderr, "Render graph: failed to create transient texture '%s'\n", texture->name);
+                    release_pool_texture(match);
+                    graph->pool_count--;
+                    return false;
+                }
+            }
+
+            match->taken = true;
+            match->busy_until = texture->last_use;
+            match->last_execute = graph->execute_count;
+            texture->view = match->view;
+        }
+    }
+    return true;
+}
+
+// Drop pool textures the recent frames haven't needed, keeping the array packed
+static void trim_pool(UGRenderGraph* graph) {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < graph->pool_count; i++) {
+        UGPoolTexture* entry = &graph->pool[i];
+        if (graph->execute_count - entry->last_execute > POOL_KEEP_EXECUTES) {
+            release_pool_texture(entry);
+            continue;
+        }
+        if (kept != i) {
+            graph->pool[kept] = *entry;
+            memset(entry, 0, sizeof(*entry));
+        }
+        kept++;
+    }
+    graph->pool_count = kept;
+}
+
+bool ug_render_graph_execute(UGRenderGraph* graph) {
+    if (!graph || !graph->frame || graph->failed) {
+        return false;
+    }
+    graph->execute_count++;
+
+    // Passes with results that outlive the graph keep everything they depend on
+    for (uint32_t i = 0; i < graph->pass_count; i++) {
+        graph->passes[i].needed = false;
+        graph->passes[i].scheduled = false;
+    }
+    for (uint32_t t = 0; t < graph->texture_count; t++) {
+        if (graph->textures[t].kind != TEXTURE_TRANSIENT) {
+            mark_needed(graph, graph->textures[t].last_writer);
+        }
+    }
+
+    schedule(graph);
+
+    for (uint32_t t = 0; t < graph->texture_count; t++) {
+        graph->textures[t].first_use = NO_PASS;
+        graph->textures[t].last_use = NO_PASS;
+    }
+    for (uint32_t position = 0; position < graph->order_count; position++) {
+        UGGraphPass* pass = &graph->passes[graph->order[position]];
+        if (pass->target != UG_RENDER_GRAPH_INVALID) {
+            touch_texture(&graph->textures[pass->target], position);
+        }
+        for (uint32_t i = 0; i < pass->read_count; i++) {
+            touch_texture(&graph->textures[pass->reads[i]], position);
+        }
+    }
+
+    bool ok = assign_transients(graph);
+    trim_pool(graph);
+    if (!ok) {
+        return false;
+    }
+
+    for (uint32_t position = 0; position < graph->order_count; position++) {
+        UGGraphPass* pass = &graph->passes[graph->order[position]];
+        if (pass->target == UG_RENDER_GRAPH_INVALID) {
+            continue;
+        }
+
+        UG_PROFILE_BEGIN("ug_render_graph_pass");
+        // A pooled texture holds whatever its previous user left, so the first
+        // write of a transient always clears
+        UGGraphTexture* target = &graph->textures[pass->target];
+        bool clear = pass->clear || (target->kind == TEXTURE_TRANSIENT && target->first_use == position);
+        UGRenderPass* render_pass = ug_render_pass_begin_target(graph->frame, target->view, clear,
+                                                                pass->clear_color[0], pass->clear_color[1],
+                                                                pass->clear_color[2], pass->clear_color[3]);
+        if (render_pass) {
+            pass->callback(graph, render_pass, pass->userdata);
+            ug_render_pass_end(render_pass);
+        }
+        UG_PROFILE_END();
+    }
+
+    return true;
+}
+
+WGPUTextureView ug_render_graph_get_view(UGRenderGraph* graph, UGRenderGraphTexture texture) {
+    if (!graph || !valid_texture(graph, texture)) {
+        return NULL;
+    }
+    return graph->textures[texture].view;
+}
+
+bool ug_render_graph_pass_is_culled(UGRenderGraph* graph, UGRenderGraphPass pass) {
+    UGGraphPass* graph_pass = get_pass(graph, pass);
+    return graph_pass && !graph_pass->needed;
+}
+
+uint32_t ug_render_graph_get_pool_texture_count(UGRenderGraph* graph) {
+    return graph ? graph->pool_count : 0;
+}
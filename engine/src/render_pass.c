@@ -1,89 +1,533 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Draw recorded but not yet issued, so a following contiguous draw can extend it
+typedef enum {
+    UG_PENDING_NONE,
+    UG_PENDING_DRAW,
+    UG_PENDING_DRAW_INDEXED,
+} UGPendingDrawKind;
+
+typedef struct {
+    UGPendingDrawKind kind;
+    uint32_t first;         // First vertex or first index
+    uint32_t count;
+    int32_t base_vertex;    // Indexed draws only
+    uint32_t first_instance;
+    uint32_t instance_count;
+} UGPendingDraw;
+
+typedef struct {
+    WGPUBuffer buffer;
+    uint64_t offset;
+} UGBoundVertexBuffer;
 
 // Simplified render pass for common rendering scenarios
+// Pass objects are owned by the frame slot and reused every frame
+// The bound state is mirrored here so calls that change nothing never reach
+// the encoder, and back-to-back draws over contiguous ranges become one draw
 struct UGRenderPass {
+    UGRenderFrame* frame;
     WGPURenderPassEncoder encoder;
     WGPURenderPipeline pipeline;
-    UGVertexBuffer* vertex_buffer;
+    uint32_t primitive_vertices;    // Per primitive of the bound pipeline's list topology; 0 = never merge ranges
+    WGPUBindGroup bind_groups[UG_RENDER_PASS_MAX_BIND_GROUPS];
+    UGBoundVertexBuffer vertex_buffers[UG_RENDER_PASS_MAX_VERTEX_BUFFERS];
+    WGPUBuffer index_buffer;
+    WGPUIndexFormat index_format;
+    uint64_t index_offset;
+    UGPendingDraw pending;
+    UGFrameCounters* counters;      // Owning context's counters for the current frame
 };
 
+UGRenderPass* ug_render_pass_alloc(void) {
+    return (UGRenderPass*)calloc(1, sizeof(UGRenderPass));
+}
+
+void ug_render_pass_free(UGRenderPass* pass) {
+    free(pass);
+}
+
+bool ug_render_pass_is_recording(UGRenderPass* pass) {
+    return pass && pass->encoder;
+}
+
+static void reset_bound_state(UGRenderPass* pass) {
+    pass->pipeline = NULL;
+    pass->primitive_vertices = 0;
+    memset(pass->bind_groups, 0, sizeof(pass->bind_groups));
+    memset(pass->vertex_buffers, 0, sizeof(pass->vertex_buffers));
+    pass->index_buffer = NULL;
+    pass->index_format = WGPUIndexFormat_Undefined;
+    pass->index_offset = 0;
+    pass->pending.kind = UG_PENDING_NONE;
+}
+
+// Issue the held-back draw; must run before anything the draw depends on changes
+static void flush_pending_draw(UGRenderPass* pass) {
+    UGPendingDraw* pending = &pass->pending;
+    switch (pending->kind) {
+    case UG_PENDING_DRAW:
+        wgpuRenderPassEncoderDraw(pass->encoder, pending->count, pending->instance_count,
+                                  pending->first, pending->first_instance);
+        break;
+    case UG_PENDING_DRAW_INDEXED:
+        wgpuRenderPassEncoderDrawIndexed(pass->encoder, pending->count, pending->instance_count, pending->first,
+                                         pending->base_vertex, pending->first_instance);
+        break;
+    case UG_PENDING_NONE:
+        return;
+    }
+
+    pending->kind = UG_PENDING_NONE;
+    if (pass->counters) pass->counters->draw_calls++;
+}
+
+static void note_redundant(UGRenderPass* pass) {
+    if (pass->counters) pass->counters->redundant_state_calls++;
+}
+
 UGRenderPass* ug_render_pass_begin(UGRenderFrame* frame, float r, float g, float b, float a) {
+    return ug_render_pass_begin_target(frame, NULL, true, r, g, b, a);
+}
+
+UGRenderPass* ug_render_pass_begin_target(UGRenderFrame* frame, WGPUTextureView view, bool clear,
+                                          float r, float g, float b, float a) {
+    return ug_render_pass_begin_depth(frame, view, clear, r, g, b, a, NULL);
+}
+
+static bool format_has_depth(WGPUTextureFormat format) {
+    return format != WGPUTextureFormat_Stencil8;
+}
+
+static bool format_has_stencil(WGPUTextureFormat format) {
+    return format == WGPUTextureFormat_Stencil8 || format == WGPUTextureFormat_Depth24PlusStencil8 ||
+           format == WGPUTextureFormat_Depth32FloatStencil8;
+}
+
+// Fill out from depth; default_view stands in for a NULL depth->view
+static bool resolve_depth_attachment(const UGDepthAttachment* depth, WGPUTextureView default_view,
+                                     WGPUTextureFormat default_format,
+                                     WGPURenderPassDepthStencilAttachment* out) {
+    WGPUTextureView depth_view = depth->view;
+    WGPUTextureFormat depth_format = depth->format;
+    if (!depth_view) {
+        depth_view = default_view;
+        depth_format = default_format;
+    }
+    if (!depth_view) {
+        return false;
+    }
+
+    WGPULoadOp load_op = depth->clear ? WGPULoadOp_Clear : WGPULoadOp_Load;
+    WGPUStoreOp store_op = depth->discard ? WGPUStoreOp_Discard : WGPUStoreOp_Store;
+    *out = (WGPURenderPassDepthStencilAttachment){0};
+    out->view = depth_view;
+    // Aspects the format lacks must leave their ops undefined
+    if (format_has_depth(depth_format)) {
+        out->depthLoadOp = load_op;
+        out->depthStoreOp = store_op;
+        out->depthClearValue = depth->clear_depth;
+    }
+    if (format_has_stencil(depth_format)) {
+        out->stencilLoadOp = load_op;
+        out->stencilStoreOp = store_op;
+        out->stencilClearValue = depth->clear_stencil;
+    }
+    return true;
+}
+
+UGRenderPass* ug_render_pass_begin_depth(UGRenderFrame* frame, WGPUTextureView view, bool clear,
+                                         float r, float g, float b, float a, const UGDepthAttachment* depth) {
     if (!frame) {
         return NULL;
     }
 
-    UGRenderPass* pass = (UGRenderPass*)calloc(1, sizeof(UGRenderPass));
+    UGContext* context = ug_render_frame_get_context(frame);
+    UGPassRecorder recorder = {
+        .encoder = ug_render_frame_get_encoder(frame),
+        .counters = ug_context_get_frame_counters(context),
+        .msaa_view = ug_context_get_msaa_view(context),
+        .depth_view = depth && !depth->view ? ug_context_get_depth_view(context) : NULL,
+        .timestamps = true,
+    };
+
+    // Resolve the depth target before acquiring the pass so failure leaves nothing to undo
+    if (depth && !recorder.depth_view && !depth->view) {
+        return NULL;
+    }
+
+    UGRenderPass* pass = ug_render_frame_acquire_pass(frame);
     if (!pass) {
         return NULL;
     }
 
-    WGPUTextureView view = ug_render_frame_get_view(frame);
-    WGPUCommandEncoder encoder = ug_render_frame_get_encoder(frame);
+    return ug_render_pass_begin_recording(pass, frame, &recorder, view, clear, r, g, b, a, depth);
+}
+
+UGRenderPass* ug_render_pass_begin_recording(UGRenderPass* pass, UGRenderFrame* frame,
+                                             const UGPassRecorder* recorder, WGPUTextureView view, bool clear,
+                                             float r, float g, float b, float a, const UGDepthAttachment* depth) {
+    UGContext* context = ug_render_frame_get_context(frame);
+    WGPURenderPassDepthStencilAttachment depth_attachment;
+    if (depth && !resolve_depth_attachment(depth, recorder->depth_view, ug_context_get_depth_format(context),
+                                           &depth_attachment)) {
+        ug_render_frame_release_pass(frame, pass);
+        return NULL;
+    }
+
+    pass->frame = frame;
+    pass->counters = recorder->counters;
+
+    WGPUTextureView frame_view = ug_render_frame_get_view(frame);
+    if (!view) {
+        view = frame_view;
+    }
 
     // Setup render pass with clear color
     WGPURenderPassColorAttachment color_attachment = {
         .view = view,
         .depthSlice = WGPU_DEPTH_SLICE_UNDEFINED,
-        .loadOp = WGPULoadOp_Clear,
+        .loadOp = clear ? WGPULoadOp_Clear : WGPULoadOp_Load,
         .storeOp = WGPUStoreOp_Store,
         .clearValue = {r, g, b, a},
     };
 
+    // With MSAA, passes on the frame draw into the multisampled target and
+    // resolve into the frame's view. The samples are stored too, so a later
+    // pass that loads instead of clearing continues from them
+    if (recorder->msaa_view && view == frame_view) {
+        color_attachment.view = recorder->msaa_view;
+        color_attachment.resolveTarget = frame_view;
+    }
+
     WGPURenderPassDescriptor render_pass_desc = {
         .colorAttachmentCount = 1,
         .colorAttachments = &color_attachment,
+        .depthStencilAttachment = depth ? &depth_attachment : NULL,
     };
 
-    pass->encoder = wgpuCommandEncoderBeginRenderPass(encoder, &render_pass_desc);
-    pass->pipeline = NULL;
-    pass->vertex_buffer = NULL;
+    // Bracket the pass with timestamps when the GPU profiler is on
+    WGPURenderPassTimestampWrites timestamp_writes;
+    UGGpuProfiler* profiler = ug_context_get_gpu_profiler(context);
+    if (recorder->timestamps &&
+        ug_gpu_profiler_next_pass(profiler, ug_render_frame_get_index(frame), &timestamp_writes)) {
+        render_pass_desc.timestampWrites = &timestamp_writes;
+    }
+
+    pass->encoder = wgpuCommandEncoderBeginRenderPass(recorder->encoder, &render_pass_desc);
+    reset_bound_state(pass);
 
     return pass;
 }
 
+// Ranges can only be joined for list topologies, where a range that covers
+// whole primitives ends on a primitive boundary
+static uint32_t list_primitive_vertices(WGPUPrimitiveTopology topology) {
+    switch (topology) {
+    case WGPUPrimitiveTopology_TriangleList: return 3;
+    case WGPUPrimitiveTopology_LineList: return 2;
+    case WGPUPrimitiveTopology_PointList: return 1;
+    default: return 0;
+    }
+}
+
 void ug_render_pass_set_pipeline(UGRenderPass* pass, WGPURenderPipeline pipeline) {
+    ug_render_pass_set_pipeline_topology(pass, pipeline, WGPUPrimitiveTopology_Undefined);
+}
+
+void ug_render_pass_set_pipeline_topology(UGRenderPass* pass, WGPURenderPipeline pipeline,
+                                          WGPUPrimitiveTopology topology) {
     if (!pass || !pipeline) {
         return;
     }
 
+    uint32_t primitive_vertices = list_primitive_vertices(topology);
+    if (pass->pipeline == pipeline) {
+        if (pass->primitive_vertices != primitive_vertices) {
+            flush_pending_draw(pass);
+            pass->primitive_vertices = primitive_vertices;
+        }
+        note_redundant(pass);
+        return;
+    }
+
+    flush_pending_draw(pass);
     pass->pipeline = pipeline;
+    pass->primitive_vertices = primitive_vertices;
     wgpuRenderPassEncoderSetPipeline(pass->encoder, pipeline);
+    if (pass->counters) pass->counters->pipeline_switches++;
 }
 
 void ug_render_pass_set_vertex_buffer(UGRenderPass* pass, UGVertexBuffer* vertex_buffer) {
-    if (!pass || !vertex_buffer) {
+    ug_render_pass_set_vertex_buffer_slot(pass, 0, vertex_buffer, 0);
+}
+
+void ug_render_pass_set_vertex_buffer_slot(UGRenderPass* pass, uint32_t slot,
+                                           UGVertexBuffer* vertex_buffer, uint64_t offset) {
+    if (!pass || !vertex_buffer || slot >= UG_RENDER_PASS_MAX_VERTEX_BUFFERS) {
         return;
     }
 
-    pass->vertex_buffer = vertex_buffer;
     WGPUBuffer buffer = ug_vertex_buffer_get_handle(vertex_buffer);
-    wgpuRenderPassEncoderSetVertexBuffer(pass->encoder, 0, buffer, 0, WGPU_WHOLE_SIZE);
+    UGBoundVertexBuffer* bound = &pass->vertex_buffers[slot];
+    if (bound->buffer == buffer && bound->offset == offset) {
+        note_redundant(pass);
+        return;
+    }
+
+    flush_pending_draw(pass);
+    bound->buffer = buffer;
+    bound->offset = offset;
+    wgpuRenderPassEncoderSetVertexBuffer(pass->encoder, slot, buffer, offset, WGPU_WHOLE_SIZE);
+}
+
+void ug_render_pass_set_index_buffer(UGRenderPass* pass, UGIndexBuffer* index_buffer, uint64_t offset) {
+    if (!pass || !index_buffer) {
+        return;
+    }
+
+    WGPUBuffer buffer = ug_index_buffer_get_handle(index_buffer);
+    WGPUIndexFormat format = ug_index_buffer_get_format(index_buffer);
+    if (pass->index_buffer == buffer && pass->index_format == format && pass->index_offset == offset) {
+        note_redundant(pass);
+        return;
+    }
+
+    flush_pending_draw(pass);
+    pass->index_buffer = buffer;
+    pass->index_format = format;
+    pass->index_offset = offset;
+    wgpuRenderPassEncoderSetIndexBuffer(pass->encoder, buffer, format, offset, WGPU_WHOLE_SIZE);
 }
 
 void ug_render_pass_set_bind_group(UGRenderPass* pass, uint32_t group_index, WGPUBindGroup bind_group) {
-    if (!pass || !bind_group) {
+    if (!pass || !bind_group || group_index >= UG_RENDER_PASS_MAX_BIND_GROUPS) {
         return;
     }
 
+    if (pass->bind_groups[group_index] == bind_group) {
+        note_redundant(pass);
+        return;
+    }
+
+    flush_pending_draw(pass);
+    pass->bind_groups[group_index] = bind_group;
     wgpuRenderPassEncoderSetBindGroup(pass->encoder, group_index, bind_group, 0, NULL);
+    if (pass->counters) pass->counters->bind_group_switches++;
+}
+
+// Extend the pending draw when the new one continues it - the same range for
+// the next instances, or the next vertex/index range - otherwise issue it and
+// hold the new one back instead. Ranges only merge for single-instance draws of
+// whole primitives on a pipeline bound with a list topology: joining strips adds
+// primitives, partial ones would regroup, and merging instanced ranges reorders
+// primitives
+static void queue_draw(UGRenderPass* pass, UGPendingDrawKind kind, uint32_t first, uint32_t count,
+                       int32_t base_vertex, uint32_t first_instance, uint32_t instance_count) {
+    if (count == 0 || instance_count == 0) {
+        return;
+    }
+
+    UGPendingDraw* pending = &pass->pending;
+    if (pending->kind == kind && pending->base_vertex == base_vertex) {
+        bool same_instances = pending->first_instance == first_instance &&
+                              pending->instance_count == instance_count;
+        bool same_range = pending->first == first && pending->count == count;
+        uint32_t primitive = pass->primitive_vertices;
+        bool whole_primitives = primitive != 0 && instance_count == 1 &&
+                                pending->count % primitive == 0 && count % primitive == 0;
+        if (same_instances && whole_primitives && pending->first + pending->count == first &&
+            pending->count <= UINT32_MAX - count) {
+            pending->count += count;
+            if (pass->counters) pass->counters->merged_draws++;
+            return;
+        }
+        if (same_range && pending->first_instance + pending->instance_count == first_instance &&
+            pending->instance_count <= UINT32_MAX - instance_count) {
+            pending->instance_count += instance_count;
+            if (pass->counters) pass->counters->merged_draws++;
+            return;
+        }
+    }
+
+    flush_pending_draw(pass);
+    pending->kind = kind;
+    pending->first = first;
+    pending->count = count;
+    pending->base_vertex = base_vertex;
+    pending->first_instance = first_instance;
+    pending->instance_count = instance_count;
 }
 
 void ug_render_pass_draw(UGRenderPass* pass, uint32_t vertex_count) {
+    ug_render_pass_draw_range(pass, 0, vertex_count);
+}
+
+void ug_render_pass_draw_range(UGRenderPass* pass, uint32_t first_vertex, uint32_t vertex_count) {
+    ug_render_pass_draw_instanced(pass, vertex_count, 1, first_vertex, 0);
+}
+
+void ug_render_pass_draw_instanced(UGRenderPass* pass, uint32_t vertex_count, uint32_t instance_count,
+                                   uint32_t first_vertex, uint32_t first_instance) {
     if (!pass) {
         return;
     }
 
-    wgpuRenderPassEncoderDraw(pass->encoder, vertex_count, 1, 0, 0);
+    queue_draw(pass, UG_PENDING_DRAW, first_vertex, vertex_count, 0, first_instance, instance_count);
 }
 
 void ug_render_pass_draw_indexed(UGRenderPass* pass, uint32_t index_count) {
+    ug_render_pass_draw_indexed_range(pass, 0, index_count, 0);
+}
+
+void ug_render_pass_draw_indexed_range(UGRenderPass* pass, uint32_t first_index, uint32_t index_count,
+                                       int32_t base_vertex) {
+    ug_render_pass_draw_indexed_instanced(pass, index_count, 1, first_index, base_vertex, 0);
+}
+
+void ug_render_pass_draw_indexed_instanced(UGRenderPass* pass, uint32_t index_count, uint32_t instance_count,
+                                           uint32_t first_index, int32_t base_vertex, uint32_t first_instance) {
     if (!pass) {
         return;
     }
 
-    wgpuRenderPassEncoderDrawIndexed(pass->encoder, index_count, 1, 0, 0, 0);
+    queue_draw(pass, UG_PENDING_DRAW_INDEXED, first_index, index_count, base_vertex,
+               first_instance, instance_count);
+}
+
+void ug_render_pass_draw_quads(UGRenderPass* pass, uint32_t first_quad, uint32_t quad_count) {
+    if (!pass || quad_count == 0) {
+        return;
+    }
+
+    UGContext* context = ug_render_frame_get_context(pass->frame);
+    ug_render_pass_set_index_buffer(pass, ug_context_get_quad_index_buffer(context), 0);
+
+    // 16-bit indices reach UG_QUAD_INDEX_MAX_QUADS quads; beyond that, shift
+    // each block of quads onto the same indices with base_vertex
+    while (quad_count > 0) {
+        uint32_t block = first_quad / UG_QUAD_INDEX_MAX_QUADS;
+        uint32_t quad_in_block = first_quad % UG_QUAD_INDEX_MAX_QUADS;
+        uint32_t count = UG_QUAD_INDEX_MAX_QUADS - quad_in_block;
+        if (count > quad_count) {
+            count = quad_count;
+        }
+
+        ug_render_pass_draw_indexed_range(pass, quad_in_block * 6, count * 6,
+                                          (int32_t)(block * UG_QUAD_INDEX_MAX_QUADS * 4));
+        first_quad += count;
+        quad_count -= count;
+    }
+}
+
+void ug_render_pass_draw_indirect(UGRenderPass* pass, UGIndirectBuffer* commands, uint32_t command_index) {
+    if (!pass || !commands || command_index >= ug_indirect_buffer_get_capacity(commands)) {
+        return;
+    }
+
+    flush_pending_draw(pass);
+    WGPUBuffer buffer = ug_indirect_buffer_get_handle(commands);
+    uint64_t offset = (uint64_t)command_index * ug_indirect_buffer_get_command_size(commands);
+    if (ug_indirect_buffer_is_indexed(commands)) {
+        wgpuRenderPassEncoderDrawIndexedIndirect(pass->encoder, buffer, offset);
+    } else {
+        wgpuRenderPassEncoderDrawIndirect(pass->encoder, buffer, offset);
+    }
+    if (pass->counters) pass->counters->draw_calls++;
+}
+
+void ug_render_pass_multi_draw_indirect(UGRenderPass* pass, UGIndirectBuffer* commands,
+                                        uint32_t first_command, uint32_t command_count) {
+    if (!pass || !commands || command_count == 0) {
+        return;
+    }
+
+    size_t capacity = ug_indirect_buffer_get_capacity(commands);
+    if (first_command >= capacity) {
+        return;
+    }
+    if (command_count > capacity - first_command) {
+        command_count = (uint32_t)(capacity - first_command);
+    }
+
+    flush_pending_draw(pass);
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    WGPUBuffer buffer = ug_indirect_buffer_get_handle(commands);
+    uint64_t offset = (uint64_t)first_command * ug_indirect_buffer_get_command_size(commands);
+    if (ug_indirect_buffer_is_indexed(commands)) {
+        wgpuRenderPassEncoderMultiDrawIndexedIndirect(pass->encoder, buffer, offset, command_count);
+    } else {
+        wgpuRenderPassEncoderMultiDrawIndirect(pass->encoder, buffer, offset, command_count);
+    }
+    if (pass->counters) pass->counters->draw_calls += command_count;
+#else
+    for (uint32_t i = 0; i < command_count; i++) {
+        ug_render_pass_draw_indirect(pass, commands, first_command + i);
+    }
+#endif
+}
+
+bool ug_render_pass_multi_draw_indirect_count(UGRenderPass* pass, UGIndirectBuffer* commands,
+                                              uint32_t first_command, uint32_t max_count,
+                                              WGPUBuffer count_buffer, uint64_t count_offset) {
+    if (!pass || !commands || !count_buffer) {
+        return false;
+    }
+
+    UGContext* context = ug_render_frame_get_context(pass->frame);
+    if (!ug_context_supports_multi_draw_indirect_count(context)) {
+        return false;
+    }
+
+    size_t capacity = ug_indirect_buffer_get_capacity(commands);
+    if (first_command >= capacity) {
+        return false;
+    }
+    if (max_count > capacity - first_command) {
+        max_count = (uint32_t)(capacity - first_command);
+    }
+
+#if defined(UG_HAVE_WGPU_NATIVE_H)
+    flush_pending_draw(pass);
+    WGPUBuffer buffer = ug_indirect_buffer_get_handle(commands);
+    uint64_t offset = (uint64_t)first_command * ug_indirect_buffer_get_command_size(commands);
+    if (ug_indirect_buffer_is_indexed(commands)) {
+        wgpuRenderPassEncoderMultiDrawIndexedIndirectCount(pass->encoder, buffer, offset, count_buffer,
+                                                           count_offset, max_count);
+    } else {
+        wgpuRenderPassEncoderMultiDrawIndirectCount(pass->encoder, buffer, offset, count_buffer,
+                                                    count_offset, max_count);
+    }
+    // The real count is only known to the GPU; report the upper bound
+    if (pass->counters) pass->counters->draw_calls += max_count;
+    return true;
+#else
+    (void)count_offset;
+    return false;
+#endif
+}
+
+bool ug_render_pass_execute_bundle(UGRenderPass* pass, UGRenderBundle* bundle) {
+    if (!pass) {
+        return false;
+    }
+
+    WGPURenderBundle handle = ug_render_bundle_get_handle(bundle);
+    if (!handle) {
+        return false;
+    }
+
+    flush_pending_draw(pass);
+    wgpuRenderPassEncoderExecuteBundles(pass->encoder, 1, &handle);
+    if (pass->counters) pass->counters->draw_calls += ug_render_bundle_get_draw_count(bundle);
+
+    // Executing bundles clears the pass's pipeline, bind groups and buffers
+    reset_bound_state(pass);
+    return true;
 }
 
 void ug_render_pass_end(UGRenderPass* pass) {
@@ -92,10 +536,11 @@ void ug_render_pass_end(UGRenderPass* pass) {
     }
 
     if (pass->encoder) {
+        flush_pending_draw(pass);
         wgpuRenderPassEncoderEnd(pass->encoder);
         wgpuRenderPassEncoderRelease(pass->encoder);
+        pass->encoder = NULL;
     }
-    
-    free(pass);
-}
 
+    ug_render_frame_release_pass(pass->frame, pass);
+}
@@ -0,0 +1,139 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool ug_shadow_copy_init(UGShadowCopy* shadow, size_t size) {
+    memset(shadow, 0, sizeof(*shadow));
+    shadow->data = (uint8_t*)calloc(1, size);
+    if (!shadow->data) {
+        return false;
+    }
+    shadow->size = size;
+    return true;
+}
+
+bool ug_shadow_copy_resize(UGShadowCopy* shadow, size_t size) {
+    uint8_t* data = (uint8_t*)realloc(shadow->data, size);
+    if (!data) {
+        return false;
+    }
+    if (size > shadow->size) {
+        memset(data + shadow->size, 0, size - shadow->size);
+    }
+    shadow->data = data;
+    shadow->size = size;
+
+    // Spans past the new end have nothing left to upload
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < shadow->span_count; i++) {
+        UGByteSpan span = shadow->spans[i];
+        if (span.start >= size) continue;
+        if (span.end > size) span.end = size;
+        shadow->spans[kept++] = span;
+    }
+    shadow->span_count = kept;
+    return true;
+}
+
+void ug_shadow_copy_release(UGShadowCopy* shadow) {
+    free(shadow->data);
+    memset(shadow, 0, sizeof(*shadow));
+}
+
+void ug_shadow_copy_mark_dirty(UGShadowCopy* shadow, size_t start, size_t end) {
+    // Queue writes need 4-byte aligned offsets and sizes
+    start &= ~(size_t)3;
+    end = (end + 3) & ~(size_t)3;
+    if (end > shadow->size) end = shadow->size;
+    if (start >= end) {
+        return;
+    }
+
+    // Spans stay sorted and disjoint. Anything within UG_SHADOW_MERGE_GAP of the
+    // new span is absorbed: one slightly larger write beats two small ones
+    uint32_t first = 0;
+    while (first < shadow->span_count && shadow->spans[first].end + UG_SHADOW_MERGE_GAP < start) {
+        first++;
+    }
+    uint32_t last = first;
+    while (last < shadow->span_count && shadow->spans[last].start <= end + UG_SHADOW_MERGE_GAP) {
+        if (shadow->spans[last].start < start) start = shadow->spans[last].start;
+        if (shadow->spans[last].end > end) end = shadow->spans[last].end;
+        last++;
+    }
+
+    uint32_t removed = last - first;
+    if (removed == 0) {
+        if (shadow->span_count == UG_SHADOW_MAX_SPANS) {
+            // Out of spans: merge the pair with the smallest gap to free one,
+            // then retry (the new span may sit in the freed gap)
+            uint32_t best = 0;
+            size_t best_gap = SIZE_MAX;
+            for (uint32_t i = 0; i + 1 < shadow->span_count; i++) {
+                size_t gap = shadow->spans[i + 1].start - shadow->spans[i].end;
+                if (gap < best_gap) {
+                    best_gap = gap;
+                    best = i;
+                }
+            }
+            shadow->spans[best].end = shadow->spans[best + 1].end;
+            memmove(&shadow->spans[best + 1], &shadow->spans[best + 2],
+                    (shadow->span_count - best - 2) * sizeof(UGByteSpan));
+            shadow->span_count--;
+            ug_shadow_copy_mark_dirty(shadow, start, end);
+            return;
+        }
+        memmove(&shadow->spans[first + 1], &shadow->spans[first],
+                (shadow->span_count - first) * sizeof(UGByteSpan));
+        shadow->span_count++;
+    } else if (removed > 1) {
+        memmove(&shadow->spans[first + 1], &shadow->spans[last],
+                (shadow->span_count - last) * sizeof(UGByteSpan));
+        shadow->span_count -= removed - 1;
+    }
+    shadow->spans[first].start = start;
+    shadow->spans[first].end = end;
+}
+
+void ug_shadow_copy_write(UGShadowCopy* shadow, size_t offset, const void* data, size_t size,
+                          size_t granularity) {
+    if (offset >= shadow->size) {
+        return;
+    }
+    if (size > shadow->size - offset) {
+        size = shadow->size - offset;
+    }
+
+    // Compare element by element and only copy and mark the runs that differ
+    const uint8_t* src = (const uint8_t*)data;
+    uint8_t* dst = shadow->data + offset;
+    size_t run_start = SIZE_MAX;
+    for (size_t at = 0; at < size; at += granularity) {
+        size_t chunk = size - at < granularity ? size - at : granularity;
+        bool changed = memcmp(dst + at, src + at, chunk) != 0;
+        if (changed) {
+            memcpy(dst + at, src + at, chunk);
+            if (run_start == SIZE_MAX) run_start = at;
+        } else if (run_start != SIZE_MAX) {
+            ug_shadow_copy_mark_dirty(shadow, offset + run_start, offset + at);
+            run_start = SIZE_MAX;
+        }
+    }
+    if (run_start != SIZE_MAX) {
+        ug_shadow_copy_mark_dirty(shadow, offset + run_start, offset + size);
+    }
+}
+
+size_t ug_shadow_copy_flush(UGShadowCopy* shadow, WGPUQueue queue, WGPUBuffer buffer) {
+    size_t uploaded = 0;
+    for (uint32_t i = 0; i < shadow->span_count; i++) {
+        UGByteSpan span = shadow->spans[i];
+        wgpuQueueWriteBuffer(queue, buffer, span.start, shadow->data + span.start, span.end - span.start);
+        uploaded += span.end - span.start;
+    }
+    shadow->span_count = 0;
+    return uploaded;
+}
@@ -45,12 +45,8 @@ void ug_sprite_sheet_destroy(UGSpriteSheet* sheet) {
     }
 }
 
-void ug_sprite_sheet_add_sprite(UGSpriteSheet* sheet, UGVertex2DTextured* vertices, size_t* count,
-                                int sprite_index, float x, float y, float w, float h) {
-    if (!sheet || !vertices || !count) {
-        return;
-    }
-    
+// UV rectangle of a sprite, with the index clamped to the sheet
+static void get_sprite_uvs(UGSpriteSheet* sheet, int sprite_index, float* u0, float* v0, float* u1, float* v1) {
     // Clamp sprite index to valid range
     if (sprite_index < 0) sprite_index = 0;
     if (sprite_index >= sheet->total_sprites) sprite_index = sheet->total_sprites - 1;
@@ -60,15 +56,36 @@ void ug_sprite_sheet_add_sprite(UGSpriteSheet* sheet, UGVertex2DTextured* vertic
     int sprite_y = sprite_index / sheet->sprites_per_row;
     
     // Calculate UV coordinates
-    float u0 = (float)(sprite_x * sheet->sprite_width) / (float)sheet->texture_width;
-    float v0 = (float)(sprite_y * sheet->sprite_height) / (float)sheet->texture_height;
-    float u1 = (float)((sprite_x + 1) * sheet->sprite_width) / (float)sheet->texture_width;
-    float v1 = (float)((sprite_y + 1) * sheet->sprite_height) / (float)sheet->texture_height;
+    *u0 = (float)(sprite_x * sheet->sprite_width) / (float)sheet->texture_width;
+    *v0 = (float)(sprite_y * sheet->sprite_height) / (float)sheet->texture_height;
+    *u1 = (float)((sprite_x + 1) * sheet->sprite_width) / (float)sheet->texture_width;
+    *v1 = (float)((sprite_y + 1) * sheet->sprite_height) / (float)sheet->texture_height;
+}
+
+void ug_sprite_sheet_add_sprite(UGSpriteSheet* sheet, UGVertex2DTextured* vertices, size_t* count,
+                                int sprite_index, float x, float y, float w, float h) {
+    if (!sheet || !vertices || !count) {
+        return;
+    }
+    
+    float u0, v0, u1, v1;
+    get_sprite_uvs(sheet, sprite_index, &u0, &v0, &u1, &v1);
     
     // Use the existing geometry helper to add the textured rectangle
     ug_add_rect_2d_textured(vertices, count, x, y, w, h, u0, v0, u1, v1);
 }
 
+void ug_sprite_sheet_add_sprite_indexed(UGSpriteSheet* sheet, UGVertex2DTextured* vertices, size_t* count,
+                                        int sprite_index, float x, float y, float w, float h) {
+    if (!sheet || !vertices || !count) {
+        return;
+    }
+
+    float u0, v0, u1, v1;
+    get_sprite_uvs(sheet, sprite_index, &u0, &v0, &u1, &v1);
+    ug_add_rect_2d_textured_indexed(vertices, count, x, y, w, h, u0, v0, u1, v1);
+}
+
 UGTexture* ug_sprite_sheet_get_texture(UGSpriteSheet* sheet) {
     return sheet ? sheet->texture : NULL;
 }
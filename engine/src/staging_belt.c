@@ -0,0 +1,313 @@
+#include "ungrund.h"
+#include "ug_internal.h"
+#include <webgpu/webgpu.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Allocations start 16-byte aligned so callers can write with vector stores;
+// copies only need 4
+#define STAGING_ALIGN 16
+
+// A chunk cycles FREE (mapped, empty) -> ACTIVE (mapped, being filled) ->
+// CLOSED (unmapped, copies recorded) -> MAPPING (map requested after submit)
+// and back to FREE once the GPU has finished reading it
+enum {
+    CHUNK_FREE,
+    CHUNK_ACTIVE,
+    CHUNK_CLOSED,
+    CHUNK_MAPPING,
+};
+
+typedef struct {
+    WGPUBuffer buffer;
+    uint64_t size;
+    uint64_t used;
+    uint8_t* mapped;        // Valid while FREE or ACTIVE
+    atomic_int state;       // Written by the map callback
+} UGStagingChunk;
+
+typedef struct {
+    UGStagingChunk* chunk;
+    uint64_t offset;
+    WGPUBuffer target;
+    uint64_t target_offset;
+    uint64_t size;
+} UGStagingCopy;
+
+// Pool of MapWrite|CopySrc chunks handed out as write pointers. Copies into
+// their targets are recorded on finish into the frame's upload encoder; chunks
+// are remapped once submitted
+struct UGStagingBelt {
+    UGContext* context;
+    uint64_t chunk_size;
+    UGStagingChunk** chunks;    // Pointers stay put for the map callbacks
+    size_t chunk_count;
+    size_t chunk_capacity;
+    UGStagingChunk* current;    // ACTIVE chunk allocations are carved from
+    UGStagingCopy* copies;      // Recorded by the next finish
+    size_t copy_count;
+    size_t copy_capacity;
+    uint64_t frame_number;
+};
+
+UGStagingBelt* ug_staging_belt_create(UGContext* context, size_t chunk_size) {
+    if (!context) {
+        return NULL;
+    }
+
+    UGStagingBelt* belt = (UGStagingBelt*)calloc(1, sizeof(UGStagingBelt));
+    if (!belt) {
+        return NULL;
+    }
+
+    if (chunk_size == 0) chunk_size = UG_STAGING_BELT_DEFAULT_CHUNK_SIZE;
+    belt->context = context;
+    belt->chunk_size = (chunk_size + STAGING_ALIGN - 1) & ~(uint64_t)(STAGING_ALIGN - 1);
+    belt->frame_number = UINT64_MAX;
+    return belt;
+}
+
+void ug_staging_belt_destroy(UGStagingBelt* belt) {
+    if (!belt) {
+        return;
+    }
+
+    for (size_t i = 0; i < belt->chunk_count; i++) {
+        UGStagingChunk* chunk = belt->chunks[i];
+        // The map callback writes to the chunk, so it has to land first
+        while (atomic_load(&chunk->state) == CHUNK_MAPPING) {
+            ug_context_poll(belt->context, true);
+        }
+        wgpuBufferRelease(chunk->buffer);
+        free(chunk);
+    }
+    free(belt->chunks);
+    free(belt->copies);
+    free(belt);
+}
+
+static void on_chunk_mapped(WGPUMapAsyncStatus status, WGPUStringView message,
+                            void* userdata1, void* userdata2) {
+    (void)message;
+    (void)userdata2;
+    UGStagingChunk* chunk = (UGStagingChunk*)userdata1;
+    // A failed map leaves the chunk closed; the next frame asks again
+    atomic_store(&chunk->state, status == WGPUMapAsyncStatus_Success ? CHUNK_FREE : CHUNK_CLOSED);
+}
+
+// First allocation of a new frame: everything closed by earlier frames has
+// been submitted, so it can be mapped again
+static void begin_frame(UGStagingBelt* belt, uint64_t frame_number) {
+    belt->frame_number = frame_number;
+
+    if (belt->copy_count > 0) {
+        fprintf(stderr, "Staging belt dropped %zu copies that were never finished\n", belt->copy_count);
+        belt->copy_count = 0;
+    }
+
+    for (size_t i = 0; i < belt->chunk_count; i++) {
+        UGStagingChunk* chunk = belt->chunks[i];
+        if (atomic_load(&chunk->state) != CHUNK_CLOSED) continue;
+
+        atomic_store(&chunk->state, CHUNK_MAPPING);
+        WGPUBufferMapCallbackInfo callback_info = {
+            .mode = WGPUCallbackMode_AllowSpontaneous,
+            .callback = on_chunk_mapped,
+            .userdata1 = chunk,
+        };
+        wgpuBufferMapAsync(chunk->buffer, WGPUMapMode_Write, 0, (size_t)chunk->size, callback_info);
+    }
+}
+
+static UGStagingChunk* create_chunk(UGStagingBelt* belt, uint64_t size) {
+    if (belt->chunk_count == belt->chunk_capacity) {
+        size_t capacity = belt->chunk_capacity ? belt->chunk_capacity * 2 : 8;
+        UGStagingChunk** chunks = (UGStagingChunk**)realloc(belt->chunks, capacity * sizeof(UGStagingChunk*));
+        if (!chunks) {
+            return NULL;
+        }
+        belt->chunks = chunks;
+        belt->chunk_capacity = capacity;
+    }
+
+    UGStagingChunk* chunk = (UGStagingChunk*)calloc(1, sizeof(UGStagingChunk));
+    if (!chunk) {
+        return NULL;
+    }
+
+    WGPUBufferDescriptor buffer_desc = {
+        .label = {"Staging Belt Chunk", WGPU_STRLEN},
+        .size = size,
+        .usage = WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc,
+        .mappedAtCreation = true,
+    };
+    chunk->buffer = wgpuDeviceCreateBuffer(ug_context_get_device(belt->context), &buffer_desc);
+    if (!chunk->buffer) {
+        fprintf(stderr, "Failed to create %llu byte staging chunk\n", (unsigned long long)size);
+        free(chunk);
+        return NULL;
+    }
+    chunk->size = size;
+    atomic_init(&chunk->state, CHUNK_FREE);
+
+    belt->chunks[belt->chunk_count++] = chunk;
+    return chunk;
+}
+
+// A mapped chunk with room for size bytes, recycling before creating
+static UGStagingChunk* acquire_chunk(UGStagingBelt* belt, uint64_t size) {
+    UGStagingChunk* chunk = NULL;
+    for (int attempt = 0; attempt < 2 && !chunk; attempt++) {
+        if (attempt == 1) {
+            // Pick up maps that completed since the frame began
+            ug_context_poll(belt->context, false);
+        }
+        for (size_t i = 0; i < belt->chunk_count; i++) {
+            UGStagingChunk* candidate = belt->chunks[i];
+            if (candidate->size >= size && atomic_load(&candidate->state) == CHUNK_FREE) {
+                chunk = candidate;
+                break;
+            }
+        }
+    }
+
+    if (!chunk) {
+        chunk = create_chunk(belt, size > belt->chunk_size ? size : belt->chunk_size);
+        if (!chunk) {
+            return NULL;
+        }
+    }
+
+    chunk->mapped = (uint8_t*)wgpuBufferGetMappedRange(chunk->buffer, 0, (size_t)chunk->size);
+    if (!chunk->mapped) {
+        fprintf(stderr, "Failed to get staging chunk mapping\n");
+        return NULL;
+    }
+    chunk->used = 0;
+    atomic_store(&chunk->state, CHUNK_ACTIVE);
+    return chunk;
+}
+
+void* ug_staging_belt_alloc(UGStagingBelt* belt, UGRenderFrame* frame, WGPUBuffer target,
+                            uint64_t target_offset, size_t size) {
+    if (!belt || !frame || !target || size == 0) {
+        return NULL;
+    }
+    // Padding the copy out would write stale chunk bytes past the caller's range
+    if ((target_offset | (uint64_t)size) & 3) {
+        fprintf(stderr, "Staging copy %llu+%zu is not 4-byte aligned\n",
+                (unsigned long long)target_offset, size);
+        return NULL;
+    }
+
+    uint64_t frame_number = ug_render_frame_get_number(frame);
+    if (frame_number != belt->frame_number) {
+        begin_frame(belt, frame_number);
+    }
+
+    if (belt->copy_count == belt->copy_capacity) {
+        size_t capacity = belt->copy_capacity ? belt->copy_capacity * 2 : 64;
+        UGStagingCopy* copies = (UGStagingCopy*)realloc(belt->copies, capacity * sizeof(UGStagingCopy));
+        if (!copies) {
+            return NULL;
+        }
+        belt->copies = copies;
+        belt->copy_capacity = capacity;
+    }
+
+    uint64_t copy_size = size;
+    UGStagingChunk* chunk = belt->current;
+    if (!chunk || chunk->size - chunk->used < copy_size) {
+        // The old chunk stays ACTIVE until finish unmaps it with the rest
+        chunk = acquire_chunk(belt, copy_size);
+        if (!chunk) {
+            return NULL;
+        }
+        belt->current = chunk;
+    }
+
+    uint64_t offset = chunk->used;
+    chunk->used = (offset + copy_size + STAGING_ALIGN - 1) & ~(uint64_t)(STAGING_ALIGN - 1);
+    if (chunk->used > chunk->size) chunk->used = chunk->size;
+
+    belt->copies[belt->copy_count++] = (UGStagingCopy){
+        .chunk = chunk,
+        .offset = offset,
+        .target = target,
+        .target_offset = target_offset,
+        .size = copy_size,
+    };
+
+    UGFrameCounters* counters = ug_context_get_frame_counters(belt->context);
+    if (counters) counters->upload_bytes += copy_size;
+    return chunk->mapped + offset;
+}
+
+void* ug_staging_belt_alloc_vertices(UGStagingBelt* belt, UGRenderFrame* frame, UGVertexBuffer* vb,
+                                     size_t first_vertex, size_t vertex_count) {
+    if (!vb || vertex_count == 0) {
+        return NULL;
+    }
+
+    // The copy lands behind the shadow copy's back, and a stream ring may still
+    // be drawing from wherever it would land
+    if (ug_vertex_buffer_is_shadowed(vb) || ug_vertex_buffer_is_streaming(vb)) {
+        fprintf(stderr, "Staged vertex writes need a plain vertex buffer (not shadowed or streaming)\n");
+        return NULL;
+    }
+
+    size_t capacity = ug_vertex_buffer_get_capacity(vb);
+    if (first_vertex >= capacity || vertex_count > capacity - first_vertex) {
+        fprintf(stderr, "Staged vertex range does not fit the buffer (%zu + %zu > %zu)\n",
+                first_vertex, vertex_count, capacity);
+        return NULL;
+    }
+
+    size_t vertex_size = ug_vertex_buffer_get_vertex_size(vb);
+    return ug_staging_belt_alloc(belt, frame, ug_vertex_buffer_get_handle(vb), first_vertex * vertex_size,
+                                 vertex_count * vertex_size);
+}
+
+void ug_staging_belt_finish(UGStagingBelt* belt, UGRenderFrame* frame) {
+    if (!belt || !frame) {
+        return;
+    }
+
+    // Chunks must be unmapped before the copies reading them are submitted
+    for (size_t i = 0; i < belt->chunk_count; i++) {
+        UGStagingChunk* chunk = belt->chunks[i];
+        if (atomic_load(&chunk->state) != CHUNK_ACTIVE) continue;
+        wgpuBufferUnmap(chunk->buffer);
+        chunk->mapped = NULL;
+        atomic_store(&chunk->state, CHUNK_CLOSED);
+    }
+    belt->current = NULL;
+
+    if (belt->copy_count == 0) {
+        return;
+    }
+
+    // Recorded ahead of every command list, negative orders included, so
+    // nothing the frame submits can read a target before its copy lands
+    WGPUCommandEncoder encoder = ug_render_frame_get_upload_encoder(frame);
+    if (!encoder) {
+        belt->copy_count = 0;
+        return;
+    }
+
+    UG_PROFILE_BEGIN("ug_staging_belt_finish");
+    for (size_t i = 0; i < belt->copy_count; i++) {
+        const UGStagingCopy* copy = &belt->copies[i];
+        wgpuCommandEncoderCopyBufferToBuffer(encoder, copy->chunk->buffer, copy->offset,
+                                             copy->target, copy->target_offset, copy->size);
+    }
+    UG_PROFILE_END();
+
+    belt->copy_count = 0;
+}
+
+size_t ug_staging_belt_get_chunk_count(UGStagingBelt* belt) {
+    return belt ? belt->chunk_count : 0;
+}
@@ -1,4 +1,5 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -17,11 +18,9 @@ struct UGTexture {
     int channels;
 };
 
-UGTexture* ug_texture_create_from_file(UGContext* context, const char* filepath) {
-    if (!context || !filepath) {
-        return NULL;
-    }
-    
+// Create a GPU texture from decoded RGBA8 pixels
+static UGTexture* texture_create_from_pixels(UGContext* context, const unsigned char* image_data,
+                                             int width, int height) {
     UGTexture* tex = (UGTexture*)calloc(1, sizeof(UGTexture));
     if (!tex) {
         return NULL;
@@ -29,15 +28,6 @@ UGTexture* ug_texture_create_from_file(UGContext* context, const char* filepath)
     
     tex->device = ug_context_get_device(context);
     
-    // Load image using stb_image
-    int width, height, channels;
-    unsigned char* image_data = stbi_load(filepath, &width, &height, &channels, 4); // Force RGBA
-    if (!image_data) {
-        fprintf(stderr, "Failed to load image: %s\n", filepath);
-        free(tex);
-        return NULL;
-    }
-    
     tex->width = width;
     tex->height = height;
     tex->channels = 4; // We forced RGBA
@@ -69,9 +59,9 @@ UGTexture* ug_texture_create_from_file(UGContext* context, const char* filepath)
     
     WGPUQueue queue = ug_context_get_queue(context);
     wgpuQueueWriteTexture(queue, &dest, image_data, width * height * 4, &data_layout, &texture_desc.size);
-    
-    // Free image data
-    stbi_image_free(image_data);
+
+    UGFrameCounters* counters = ug_context_get_frame_counters(context);
+    if (counters) counters->upload_bytes += (uint64_t)width * height * 4;
     
     // Create texture view
     WGPUTextureViewDescriptor view_desc = {
@@ -103,6 +93,86 @@ UGTexture* ug_texture_create_from_file(UGContext* context, const char* filepath)
     return tex;
 }
 
+static UGTexture* texture_create_from_file(UGContext* context, const char* filepath) {
+    if (!context || !filepath) {
+        return NULL;
+    }
+    
+    // Load image using stb_image
+    int width, height, channels;
+    unsigned char* image_data = stbi_load(filepath, &width, &height, &channels, 4); // Force RGBA
+    if (!image_data) {
+        fprintf(stderr, "Failed to load image: %s\n", filepath);
+        return NULL;
+    }
+    
+    UGTexture* tex = texture_create_from_pixels(context, image_data, width, height);
+    stbi_image_free(image_data);
+    return tex;
+}
+
+UGTexture* ug_texture_create_from_file(UGContext* context, const char* filepath) {
+    UG_PROFILE_BEGIN("ug_texture_create_from_file");
+    UGTexture* tex = texture_create_from_file(context, filepath);
+    UG_PROFILE_END();
+    return tex;
+}
+
+typedef struct {
+    const char* path;
+    unsigned char* pixels;
+    int width;
+    int height;
+} DecodedImage;
+
+static void decode_images(uint32_t begin, uint32_t end, void* data) {
+    DecodedImage* images = (DecodedImage*)data;
+    for (uint32_t i = begin; i < end; i++) {
+        int channels;
+        images[i].pixels = stbi_load(images[i].path, &images[i].width, &images[i].height, &channels, 4);
+    }
+}
+
+bool ug_texture_create_from_files(UGContext* context, const char* const* filepaths, size_t count,
+                                  UGTexture** out_textures) {
+    if (!context || !filepaths || !out_textures || count == 0) {
+        return false;
+    }
+
+    UG_PROFILE_BEGIN("ug_texture_create_from_files");
+    DecodedImage* images = (DecodedImage*)calloc(count, sizeof(DecodedImage));
+    if (!images) {
+        UG_PROFILE_END();
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        images[i].path = filepaths[i];
+    }
+
+    // Decoding is CPU-only and independent per file; GPU objects are created
+    // afterwards on the calling thread
+    ug_parallel_for(ug_context_get_job_system(context), (uint32_t)count, 1, decode_images, images);
+
+    bool ok = true;
+    for (size_t i = 0; i < count; i++) {
+        out_textures[i] = NULL;
+        if (!images[i].pixels) {
+            fprintf(stderr, "Failed to load image: %s\n", images[i].path ? images[i].path : "(null)");
+            ok = false;
+            continue;
+        }
+        out_textures[i] = texture_create_from_pixels(context, images[i].pixels, images[i].width, images[i].height);
+        if (!out_textures[i]) {
+            ok = false;
+        }
+        stbi_image_free(images[i].pixels);
+    }
+
+    free(images);
+    UG_PROFILE_END();
+    return ok;
+}
+
 void ug_texture_destroy(UGTexture* texture) {
     if (!texture) {
         return;
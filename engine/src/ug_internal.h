@@ -0,0 +1,209 @@
+#ifndef UG_INTERNAL_H
+#define UG_INTERNAL_H
+
+// Engine-internal declarations shared between translation units.
+// Not part of the public API - applications only include ungrund.h.
+
+#include "ungrund.h"
+#include <webgpu/webgpu.h>
+
+// wgpu-native ships blocking device polls and submission indices in its
+// extension header; fall back to the standard event pump when only webgpu.h
+// is installed
+#if defined(__has_include)
+#if __has_include(<webgpu/wgpu.h>)
+#include <webgpu/wgpu.h>
+#define UG_HAVE_WGPU_NATIVE_H 1
+#endif
+#endif
+
+// Window (window.c)
+// Block until an event arrives or timeout_seconds pass (negative = no timeout)
+void ug_window_wait_events(UGWindow* window, double timeout_seconds);
+// Wake a thread blocked in ug_window_wait_events; callable from any thread
+void ug_window_wake(void);
+// Input, resize, focus and expose events seen so far
+uint64_t ug_window_get_event_count(UGWindow* window);
+// Deliver an input event to the window's callbacks (and record it, if recording)
+void ug_window_dispatch_key(UGWindow* window, int key, bool pressed);
+void ug_window_dispatch_mouse_move(UGWindow* window, double x, double y);
+void ug_window_dispatch_mouse_button(UGWindow* window, UGMouseButton button, bool pressed);
+// GLFW only reports the framebuffer size on the main thread. query_size always
+// asks GLFW (main thread only); while a size is cached, ug_window_get_size
+// returns it instead, so other threads can call it
+void ug_window_query_size(UGWindow* window, int* width, int* height);
+void ug_window_set_cached_size(UGWindow* window, int width, int height);
+void ug_window_clear_cached_size(UGWindow* window);
+
+// Input log (input_log.c) - binary record of delivered input and frame deltas.
+// A recording log is fed by the window's dispatch functions; a replaying log
+// suppresses live input and dispatches the logged events instead
+typedef struct UGInputLog UGInputLog;
+UGInputLog* ug_input_log_open_record(const char* path, UGWindow* window);
+UGInputLog* ug_input_log_open_replay(const char* path, UGWindow* window);
+void ug_input_log_close(UGInputLog* log);
+void ug_window_set_input_log(UGWindow* window, UGInputLog* log);
+UGInputLog* ug_context_get_input_log(UGContext* context);
+bool ug_input_log_is_replaying(UGInputLog* log);
+bool ug_input_log_finished(UGInputLog* log);
+void ug_input_log_write_key(UGInputLog* log, int key, bool pressed);
+void ug_input_log_write_mouse_move(UGInputLog* log, double x, double y);
+void ug_input_log_write_mouse_button(UGInputLog* log, UGMouseButton button, bool pressed);
+// Called once per frame with the measured delta. Recording writes it and
+// returns it unchanged; replaying dispatches the frame's logged events and
+// returns the logged delta instead
+uint64_t ug_input_log_frame(UGInputLog* log, uint64_t delta_ns);
+
+// Context (context.c)
+WGPUInstance ug_context_get_instance(UGContext* context);
+WGPUTextureView ug_context_get_offscreen_view(UGContext* context);
+// Size of the texture the current frame renders into; the depth and MSAA
+// targets follow it
+void ug_context_set_target_size(UGContext* context, uint32_t width, uint32_t height);
+// Pump device callbacks; wait blocks until at least some submitted work completes
+void ug_context_poll(UGContext* context, bool wait);
+// Consume a pending redraw request or expired timer; also true while animating.
+// out_next_deadline_ns gets the next pending timer (0 = none)
+bool ug_context_take_redraw_request(UGContext* context, uint64_t now_ns, uint64_t* out_next_deadline_ns);
+
+// Frame ring (render_frame.c) - fixed set of preallocated frame slots
+typedef struct UGFrameRing UGFrameRing;
+UGFrameRing* ug_frame_ring_create(UGContext* context, uint32_t slot_count);
+void ug_frame_ring_destroy(UGFrameRing* ring);
+UGFrameRing* ug_context_get_frame_ring(UGContext* context);
+
+// Each frame slot owns one render pass object; passes are strictly sequential
+// on a command encoder so one is enough
+UGRenderPass* ug_render_frame_acquire_pass(UGRenderFrame* frame);
+void ug_render_frame_release_pass(UGRenderFrame* frame, UGRenderPass* pass);
+UGContext* ug_render_frame_get_context(UGRenderFrame* frame);
+// Encoder submitted ahead of every command list and the frame's own encoder,
+// for copies the whole frame reads (staging belt). Created on first use
+WGPUCommandEncoder ug_render_frame_get_upload_encoder(UGRenderFrame* frame);
+
+// Per-frame linear arena (frame_arena.c) - bump allocator over a chunk list,
+// reset in bulk at the end of each frame
+#define UG_FRAME_ARENA_DEFAULT_CHUNK_SIZE (256 * 1024)
+typedef struct UGArenaChunk UGArenaChunk;
+#define UG_FRAME_ARENA_SHRINK_FRAMES 300   // Frames under a quarter full before shrinking
+typedef struct {
+    UGArenaChunk* first;
+    UGArenaChunk* current;
+    size_t chunk_size;
+    size_t window_peak;     // Largest frame since the arena last grew or shrank
+    uint32_t low_frames;    // Consecutive frames using under a quarter of the arena
+} UGFrameArena;
+void ug_frame_arena_init(UGFrameArena* arena, size_t chunk_size);
+void* ug_frame_arena_alloc(UGFrameArena* arena, size_t size, size_t align);
+void ug_frame_arena_reset(UGFrameArena* arena);
+void ug_frame_arena_release(UGFrameArena* arena);
+
+// GPU profiler (gpu_profiler.c) - timestamp queries around every render pass,
+// read back per frame slot once the slot's fence has signalled
+typedef struct UGGpuProfiler UGGpuProfiler;
+UGGpuProfiler* ug_gpu_profiler_create(UGContext* context, uint32_t slot_count);
+void ug_gpu_profiler_destroy(UGGpuProfiler* profiler);
+UGGpuProfiler* ug_context_get_gpu_profiler(UGContext* context);
+void ug_gpu_profiler_begin_frame(UGGpuProfiler* profiler, uint32_t slot_index, uint64_t frame_number);
+bool ug_gpu_profiler_next_pass(UGGpuProfiler* profiler, uint32_t slot_index,
+                               WGPURenderPassTimestampWrites* out_writes);
+void ug_gpu_profiler_resolve(UGGpuProfiler* profiler, uint32_t slot_index, WGPUCommandEncoder encoder);
+void ug_gpu_profiler_after_submit(UGGpuProfiler* profiler, uint32_t slot_index);
+
+// Frame statistics (frame_stats.c) - rolling timing window and the counters
+// of the frame currently being recorded
+typedef enum {
+    UG_FRAME_TIMING_FRAME,
+    UG_FRAME_TIMING_CPU,
+    UG_FRAME_TIMING_ACQUIRE,
+    UG_FRAME_TIMING_SUBMIT,
+    UG_FRAME_TIMING_PRESENT,
+    UG_FRAME_TIMING_COUNT,
+} UGFrameTiming;
+typedef struct UGFrameStatsWindow UGFrameStatsWindow;
+UGFrameStatsWindow* ug_frame_stats_create(void);
+void ug_frame_stats_destroy(UGFrameStatsWindow* window);
+UGFrameStatsWindow* ug_context_get_frame_stats_window(UGContext* context);
+void ug_frame_stats_add_timing(UGFrameStatsWindow* window, UGFrameTiming timing, uint64_t ns);
+void ug_frame_stats_begin_frame(UGFrameStatsWindow* window, uint64_t now_ns);
+void ug_frame_stats_end_frame(UGFrameStatsWindow* window);
+UGFrameCounters* ug_context_get_frame_counters(UGContext* context);  // NULL without a context
+void ug_frame_counters_add(UGFrameCounters* dst, const UGFrameCounters* src);
+
+// Render bundles (render_bundle.c) - every buffer a bundle reads keeps a list
+// of linked bundles; destroying the buffer invalidates them
+typedef struct {
+    UGRenderBundle** bundles;
+    size_t count;
+    size_t capacity;
+} UGBundleLinks;
+void ug_render_bundle_invalidate(UGRenderBundle* bundle);
+void ug_bundle_links_add(UGBundleLinks* links, UGRenderBundle* bundle);
+void ug_bundle_links_remove(UGBundleLinks* links, UGRenderBundle* bundle);
+// Invalidate every linked bundle and free the list
+void ug_bundle_links_release(UGBundleLinks* links);
+UGBundleLinks* ug_vertex_buffer_get_bundle_links(UGVertexBuffer* vb);
+UGBundleLinks* ug_index_buffer_get_bundle_links(UGIndexBuffer* ib);
+
+// Vertex buffers (vertex_buffer.c) - the staging belt writes buffers directly,
+// which neither mode would see
+bool ug_vertex_buffer_is_streaming(UGVertexBuffer* vb);
+bool ug_vertex_buffer_is_shadowed(UGVertexBuffer* vb);
+
+// Shadow copies (shadow_copy.c) - CPU mirror of a GPU buffer. Writes are
+// compared against the mirror and only the changed parts are recorded as dirty
+// spans, which flush uploads. Spans are 4-byte aligned and kept sorted
+#define UG_SHADOW_MAX_SPANS 16
+#define UG_SHADOW_MERGE_GAP 256     // Bytes between spans worth uploading to save a write
+typedef struct {
+    size_t start;
+    size_t end;
+} UGByteSpan;
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    UGByteSpan spans[UG_SHADOW_MAX_SPANS];
+    uint32_t span_count;
+} UGShadowCopy;
+bool ug_shadow_copy_init(UGShadowCopy* shadow, size_t size);
+bool ug_shadow_copy_resize(UGShadowCopy* shadow, size_t size);    // Keeps contents, zero-fills growth
+void ug_shadow_copy_release(UGShadowCopy* shadow);
+void ug_shadow_copy_mark_dirty(UGShadowCopy* shadow, size_t start, size_t end);
+// Compare in granularity-sized elements (vertex size, or 4 for uniforms)
+void ug_shadow_copy_write(UGShadowCopy* shadow, size_t offset, const void* data, size_t size,
+                          size_t granularity);
+// Upload and clear the dirty spans; returns the bytes written
+size_t ug_shadow_copy_flush(UGShadowCopy* shadow, WGPUQueue queue, WGPUBuffer buffer);
+
+// Index buffers (index_buffer.c)
+// Context-owned static quad index buffer, created on first use
+UGIndexBuffer* ug_index_buffer_create_quads(UGContext* context, uint32_t quad_count);
+
+// Command lists (command_list.c) - the frame slot allocates them once, begins
+// them when handed out and finishes them, in order, when the frame is submitted
+UGCommandList* ug_command_list_alloc(void);
+void ug_command_list_free(UGCommandList* list);
+// depth resolves the context's depth buffer for the list's passes
+bool ug_command_list_begin(UGCommandList* list, UGRenderFrame* frame, int32_t order, bool depth);
+// Ends a pass left open, adds the list's counters to frame_counters
+WGPUCommandBuffer ug_command_list_finish(UGCommandList* list, UGFrameCounters* frame_counters);
+int32_t ug_command_list_get_order(UGCommandList* list);
+
+// Render pass storage (render_pass.c)
+UGRenderPass* ug_render_pass_alloc(void);
+void ug_render_pass_free(UGRenderPass* pass);
+bool ug_render_pass_is_recording(UGRenderPass* pass);  // Begun and not yet ended
+// Where a pass records: the frame's encoder, or a command list's on a worker
+typedef struct {
+    WGPUCommandEncoder encoder;
+    UGFrameCounters* counters;
+    WGPUTextureView msaa_view;      // Multisampled target for passes on the frame's view (NULL = none)
+    WGPUTextureView depth_view;     // Context depth buffer, used when the attachment names no view
+    bool timestamps;                // Allowed to take GPU profiler queries (frame thread only)
+} UGPassRecorder;
+// Begin pass on the recorder's encoder. On failure the pass is handed back to the frame
+UGRenderPass* ug_render_pass_begin_recording(UGRenderPass* pass, UGRenderFrame* frame,
+                                             const UGPassRecorder* recorder, WGPUTextureView view, bool clear,
+                                             float r, float g, float b, float a, const UGDepthAttachment* depth);
+
+#endif // UG_INTERNAL_H
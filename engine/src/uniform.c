@@ -1,13 +1,18 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 // Uniform buffer helper
 struct UGUniformBuffer {
+    UGContext* context;
     WGPUBuffer buffer;
     WGPUQueue queue;
     size_t size;
+    bool shadowed;          // Keeps a CPU copy and uploads only what changed
+    UGShadowCopy shadow;
 };
 
 UGUniformBuffer* ug_uniform_buffer_create(UGContext* context, size_t size) {
@@ -30,6 +35,7 @@ UGUniformBuffer* ug_uniform_buffer_create(UGContext* context, size_t size) {
         .mappedAtCreation = false,
     };
 
+    uniform->context = context;
     uniform->buffer = wgpuDeviceCreateBuffer(device, &buffer_desc);
     uniform->queue = ug_context_get_queue(context);
     uniform->size = aligned_size;
@@ -43,7 +49,67 @@ void ug_uniform_buffer_update(UGUniformBuffer* uniform, const void* data, size_t
     }
 
     size_t write_size = size < uniform->size ? size : uniform->size;
-    wgpuQueueWriteBuffer(uniform->queue, uniform->buffer, 0, data, write_size);
+    ug_uniform_buffer_update_range(uniform, 0, data, write_size);
+}
+
+bool ug_uniform_buffer_update_range(UGUniformBuffer* uniform, size_t offset, const void* data, size_t size) {
+    if (!ug_uniform_buffer_write(uniform, offset, data, size)) {
+        return false;
+    }
+
+    ug_uniform_buffer_flush(uniform);
+    return true;
+}
+
+bool ug_uniform_buffer_write(UGUniformBuffer* uniform, size_t offset, const void* data, size_t size) {
+    if (!uniform || !data || size == 0) {
+        return false;
+    }
+    if (offset > uniform->size || size > uniform->size - offset) {
+        fprintf(stderr, "Uniform range %zu+%zu outside the %zu-byte buffer\n", offset, size, uniform->size);
+        return false;
+    }
+
+    if (uniform->shadowed) {
+        ug_shadow_copy_write(&uniform->shadow, offset, data, size, sizeof(uint32_t));
+        return true;
+    }
+
+    // Queue writes need 4-byte alignment, which a shadow copy would round out to
+    if ((offset | size) & 3) {
+        fprintf(stderr, "Uniform range %zu+%zu is not 4-byte aligned\n", offset, size);
+        return false;
+    }
+    wgpuQueueWriteBuffer(uniform->queue, uniform->buffer, offset, data, size);
+    UGFrameCounters* counters = ug_context_get_frame_counters(uniform->context);
+    if (counters) counters->upload_bytes += size;
+    return true;
+}
+
+bool ug_uniform_buffer_enable_shadow(UGUniformBuffer* uniform) {
+    if (!uniform) {
+        return false;
+    }
+    if (uniform->shadowed) {
+        return true;
+    }
+
+    if (!ug_shadow_copy_init(&uniform->shadow, uniform->size)) {
+        return false;
+    }
+    ug_shadow_copy_mark_dirty(&uniform->shadow, 0, uniform->size);
+    uniform->shadowed = true;
+    return true;
+}
+
+void ug_uniform_buffer_flush(UGUniformBuffer* uniform) {
+    if (!uniform || !uniform->shadowed || uniform->shadow.span_count == 0) {
+        return;
+    }
+
+    size_t uploaded = ug_shadow_copy_flush(&uniform->shadow, uniform->queue, uniform->buffer);
+    UGFrameCounters* counters = ug_context_get_frame_counters(uniform->context);
+    if (counters) counters->upload_bytes += uploaded;
 }
 
 WGPUBuffer ug_uniform_buffer_get_handle(UGUniformBuffer* uniform) {
@@ -52,6 +118,9 @@ WGPUBuffer ug_uniform_buffer_get_handle(UGUniformBuffer* uniform) {
 
 void ug_uniform_buffer_destroy(UGUniformBuffer* uniform) {
     if (uniform) {
+        if (uniform->shadowed) {
+            ug_shadow_copy_release(&uniform->shadow);
+        }
         if (uniform->buffer) {
             wgpuBufferRelease(uniform->buffer);
         }
@@ -1,19 +1,58 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <webgpu/webgpu.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Vertices a frame appended to a stream buffer, retired once its slot's fence signals
+typedef struct {
+    uint64_t frame_number;
+    uint64_t end;               // Ring head after the frame's last append
+    bool live;
+} UGStreamSegment;
+
 // Dynamic vertex buffer for efficient per-frame updates
 struct UGVertexBuffer {
+    UGContext* context;
     WGPUBuffer buffer;
     WGPUQueue queue;
     size_t capacity;        // Maximum number of vertices
     size_t vertex_size;     // Size of each vertex in bytes
+    WGPUVertexStepMode step_mode;
     WGPUVertexBufferLayout layout;
     WGPUVertexAttribute* attributes;
     size_t attribute_count;
+    UGBundleLinks bundle_links; // Render bundles recorded against this buffer
+
+    // Growth policy and usage tracking
+    UGVertexBufferGrowth growth;
+    size_t initial_capacity;    // Shrinking never goes below this
+    size_t high_water_mark;     // Largest update in vertices
+    size_t window_peak;         // Largest update since the last shrink check
+    uint32_t low_updates;       // Consecutive updates below a quarter of capacity
+
+    // Stream buffers: a ring of capacity vertices. head and tail count vertices
+    // ever allocated and retired; the ring position is the count modulo capacity
+    bool streaming;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t stream_frame;      // Frame number of the latest append
+    UGStreamSegment segments[UG_MAX_FRAMES_IN_FLIGHT];  // Indexed by frame slot
+
+    bool shadowed;              // Keeps a CPU copy and uploads only what changed
+    UGShadowCopy shadow;
 };
 
+static WGPUBuffer create_buffer(UGContext* context, size_t size) {
+    WGPUBufferDescriptor buffer_desc = {
+        .size = size,
+        .usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
+        .mappedAtCreation = false,
+    };
+    return wgpuDeviceCreateBuffer(ug_context_get_device(context), &buffer_desc);
+}
+
 UGVertexBuffer* ug_vertex_buffer_create(UGContext* context, size_t vertex_size, size_t max_vertices) {
     if (!context || vertex_size == 0 || max_vertices == 0) {
         return NULL;
@@ -24,19 +63,15 @@ UGVertexBuffer* ug_vertex_buffer_create(UGContext* context, size_t vertex_size,
         return NULL;
     }
 
-    WGPUDevice device = ug_context_get_device(context);
-    
     // Create buffer with Vertex and CopyDst usage
-    WGPUBufferDescriptor buffer_desc = {
-        .size = vertex_size * max_vertices,
-        .usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
-        .mappedAtCreation = false,
-    };
-    
-    vb->buffer = wgpuDeviceCreateBuffer(device, &buffer_desc);
+    vb->context = context;
+    vb->buffer = create_buffer(context, vertex_size * max_vertices);
     vb->queue = ug_context_get_queue(context);
     vb->capacity = max_vertices;
+    vb->initial_capacity = max_vertices;
+    vb->growth.grow = true;
     vb->vertex_size = vertex_size;
+    vb->step_mode = WGPUVertexStepMode_Vertex;
     vb->attributes = NULL;
     vb->attribute_count = 0;
 
@@ -65,36 +100,314 @@ void ug_vertex_buffer_set_layout(UGVertexBuffer* vb, const UGVertexAttribute* at
 
     // Setup layout
     vb->layout.arrayStride = vb->vertex_size;
-    vb->layout.stepMode = WGPUVertexStepMode_Vertex;
+    vb->layout.stepMode = vb->step_mode;
     vb->layout.attributeCount = attribute_count;
     vb->layout.attributes = vb->attributes;
 }
 
+void ug_vertex_buffer_set_step_mode(UGVertexBuffer* vb, WGPUVertexStepMode step_mode) {
+    if (!vb) {
+        return;
+    }
+
+    vb->step_mode = step_mode;
+    vb->layout.stepMode = step_mode;
+}
+
+void ug_vertex_buffer_set_growth(UGVertexBuffer* vb, const UGVertexBufferGrowth* growth) {
+    if (vb && growth) {
+        vb->growth = *growth;
+        vb->window_peak = 0;
+        vb->low_updates = 0;
+    }
+}
+
+// Swap in a buffer of the given capacity. Contents are not carried over: every
+// update rewrites the buffer from the start
+static bool reallocate(UGVertexBuffer* vb, size_t capacity) {
+    WGPUBuffer buffer = create_buffer(vb->context, capacity * vb->vertex_size);
+    if (!buffer) {
+        return false;
+    }
+
+    // The shadow copy holds vertices that partial updates rely on; the new
+    // buffer gets all of them on the next flush
+    if (vb->shadowed) {
+        if (!ug_shadow_copy_resize(&vb->shadow, capacity * vb->vertex_size)) {
+            wgpuBufferRelease(buffer);
+            return false;
+        }
+        ug_shadow_copy_mark_dirty(&vb->shadow, 0, vb->shadow.size);
+    }
+
+    // Bundles recorded against the old buffer would keep drawing from it
+    ug_bundle_links_release(&vb->bundle_links);
+    if (vb->buffer) {
+        wgpuBufferRelease(vb->buffer);
+    }
+    vb->buffer = buffer;
+    vb->capacity = capacity;
+    return true;
+}
+
+// Apply the growth policy before an update of vertex_count vertices
+static void resize_for_update(UGVertexBuffer* vb, size_t vertex_count) {
+    const UGVertexBufferGrowth* growth = &vb->growth;
+    if (vertex_count > vb->high_water_mark) {
+        vb->high_water_mark = vertex_count;
+    }
+    if (vertex_count > vb->window_peak) {
+        vb->window_peak = vertex_count;
+    }
+
+    if (vertex_count > vb->capacity) {
+        if (!growth->grow || (growth->max_vertices && vb->capacity >= growth->max_vertices)) {
+            return;
+        }
+        size_t capacity = vb->capacity * 2;
+        if (capacity < vertex_count) {
+            capacity = vertex_count;
+        }
+        if (growth->max_vertices && capacity > growth->max_vertices) {
+            capacity = growth->max_vertices;
+        }
+        if (!reallocate(vb, capacity)) {
+            fprintf(stderr, "Failed to grow vertex buffer to %zu vertices\n", capacity);
+        }
+        vb->window_peak = 0;
+        vb->low_updates = 0;
+        return;
+    }
+
+    if (growth->shrink_after == 0 || vb->capacity <= vb->initial_capacity) {
+        return;
+    }
+    if (vertex_count * 4 >= vb->capacity) {
+        vb->low_updates = 0;
+        vb->window_peak = 0;
+        return;
+    }
+
+    // Shrink to twice the recent peak, so it sits at half capacity and the
+    // buffer doesn't bounce between sizes
+    if (++vb->low_updates >= growth->shrink_after) {
+        size_t capacity = vb->window_peak * 2;
+        if (capacity < vb->initial_capacity) {
+            capacity = vb->initial_capacity;
+        }
+        reallocate(vb, capacity);
+        vb->window_peak = 0;
+        vb->low_updates = 0;
+    }
+}
+
 void ug_vertex_buffer_update(UGVertexBuffer* vb, const void* data, size_t vertex_count) {
     if (!vb || !data || vertex_count == 0) {
         return;
     }
+    if (vb->streaming) {
+        fprintf(stderr, "Stream vertex buffers are written with ug_vertex_buffer_append\n");
+        return;
+    }
 
+    resize_for_update(vb, vertex_count);
     size_t data_size = vertex_count * vb->vertex_size;
     size_t max_size = vb->capacity * vb->vertex_size;
-    
+
+    // Only reached with growth off, at the growth limit, or out of memory
     if (data_size > max_size) {
         data_size = max_size;
     }
 
-    wgpuQueueWriteBuffer(vb->queue, vb->buffer, 0, data, data_size);
+    UG_PROFILE_BEGIN("ug_vertex_buffer_update");
+    if (vb->shadowed) {
+        ug_shadow_copy_write(&vb->shadow, 0, data, data_size, vb->vertex_size);
+        ug_vertex_buffer_flush(vb);
+    } else {
+        wgpuQueueWriteBuffer(vb->queue, vb->buffer, 0, data, data_size);
+        UGFrameCounters* counters = ug_context_get_frame_counters(vb->context);
+        if (counters) counters->upload_bytes += data_size;
+    }
+    UG_PROFILE_END();
+}
+
+bool ug_vertex_buffer_update_range(UGVertexBuffer* vb, size_t first_vertex, const void* data, size_t vertex_count) {
+    if (!ug_vertex_buffer_write(vb, first_vertex, data, vertex_count)) {
+        return false;
+    }
+
+    if (vb->shadowed) {
+        ug_vertex_buffer_flush(vb);
+    }
+    return true;
+}
+
+bool ug_vertex_buffer_write(UGVertexBuffer* vb, size_t first_vertex, const void* data, size_t vertex_count) {
+    if (!vb || !data || vertex_count == 0 || vb->streaming) {
+        return false;
+    }
+    if (first_vertex > vb->capacity || vertex_count > vb->capacity - first_vertex) {
+        fprintf(stderr, "Vertex range %zu+%zu outside the %zu-vertex buffer\n",
+                first_vertex, vertex_count, vb->capacity);
+        return false;
+    }
+    if (first_vertex + vertex_count > vb->high_water_mark) {
+        vb->high_water_mark = first_vertex + vertex_count;
+    }
+
+    size_t offset = first_vertex * vb->vertex_size;
+    size_t data_size = vertex_count * vb->vertex_size;
+    if (vb->shadowed) {
+        ug_shadow_copy_write(&vb->shadow, offset, data, data_size, vb->vertex_size);
+        return true;
+    }
+
+    // Without a shadow copy there is nothing to defer into
+    wgpuQueueWriteBuffer(vb->queue, vb->buffer, offset, data, data_size);
+    UGFrameCounters* counters = ug_context_get_frame_counters(vb->context);
+    if (counters) counters->upload_bytes += data_size;
+    return true;
+}
+
+bool ug_vertex_buffer_enable_shadow(UGVertexBuffer* vb) {
+    if (!vb || vb->streaming) {
+        return false;
+    }
+    if (vb->shadowed) {
+        return true;
+    }
+
+    // Starts out zeroed like the GPU buffer, but earlier updates are unknown:
+    // upload everything on the first flush
+    if (!ug_shadow_copy_init(&vb->shadow, vb->capacity * vb->vertex_size)) {
+        return false;
+    }
+    ug_shadow_copy_mark_dirty(&vb->shadow, 0, vb->shadow.size);
+    vb->shadowed = true;
+    return true;
+}
+
+void ug_vertex_buffer_flush(UGVertexBuffer* vb) {
+    if (!vb || !vb->shadowed || vb->shadow.span_count == 0) {
+        return;
+    }
+
+    size_t uploaded = ug_shadow_copy_flush(&vb->shadow, vb->queue, vb->buffer);
+    UGFrameCounters* counters = ug_context_get_frame_counters(vb->context);
+    if (counters) counters->upload_bytes += uploaded;
 }
 
 WGPUBuffer ug_vertex_buffer_get_handle(UGVertexBuffer* vb) {
     return vb ? vb->buffer : NULL;
 }
 
+UGVertexBuffer* ug_vertex_buffer_create_stream(UGContext* context, size_t vertex_size, size_t ring_vertices) {
+    UGVertexBuffer* vb = ug_vertex_buffer_create(context, vertex_size, ring_vertices);
+    if (!vb) {
+        return NULL;
+    }
+
+    vb->streaming = true;
+    vb->growth.grow = false;
+    return vb;
+}
+
+// Release the ring space of frames the GPU has finished. Beginning frame N
+// waited for the fence of frame N - frames_in_flight, which used the same slot
+static void retire_stream_frames(UGVertexBuffer* vb, uint64_t frame_number) {
+    uint64_t frames_in_flight = ug_context_get_frames_in_flight(vb->context);
+    for (uint32_t i = 0; i < UG_MAX_FRAMES_IN_FLIGHT; i++) {
+        UGStreamSegment* segment = &vb->segments[i];
+        if (segment->live && segment->frame_number + frames_in_flight <= frame_number) {
+            if (segment->end > vb->tail) {
+                vb->tail = segment->end;
+            }
+            segment->live = false;
+        }
+    }
+}
+
+bool ug_vertex_buffer_append(UGVertexBuffer* vb, UGRenderFrame* frame, const void* data, size_t vertex_count,
+                             uint32_t* out_first_vertex) {
+    if (!vb || !frame || !data || vertex_count == 0 || !vb->streaming) {
+        return false;
+    }
+
+    uint64_t frame_number = ug_render_frame_get_number(frame);
+    if (frame_number != vb->stream_frame) {
+        retire_stream_frames(vb, frame_number);
+        vb->stream_frame = frame_number;
+    }
+
+    // Never split a batch across the end of the ring; skip to the start instead
+    uint64_t position = vb->head % vb->capacity;
+    uint64_t padding = position + vertex_count > vb->capacity ? vb->capacity - position : 0;
+    if (vb->head + padding + vertex_count - vb->tail > vb->capacity) {
+        fprintf(stderr, "Stream vertex buffer full: %zu vertices don't fit in the %zu-vertex ring\n",
+                vertex_count, vb->capacity);
+        return false;
+    }
+    vb->head += padding;
+    position = vb->head % vb->capacity;
+
+    UG_PROFILE_BEGIN("ug_vertex_buffer_append");
+    size_t data_size = vertex_count * vb->vertex_size;
+    wgpuQueueWriteBuffer(vb->queue, vb->buffer, position * vb->vertex_size, data, data_size);
+    UG_PROFILE_END();
+    vb->head += vertex_count;
+
+    UGStreamSegment* segment = &vb->segments[ug_render_frame_get_index(frame) % UG_MAX_FRAMES_IN_FLIGHT];
+    segment->frame_number = frame_number;
+    segment->end = vb->head;
+    segment->live = true;
+
+    UGFrameCounters* counters = ug_context_get_frame_counters(vb->context);
+    if (counters) counters->upload_bytes += data_size;
+
+    if (out_first_vertex) *out_first_vertex = (uint32_t)position;
+    return true;
+}
+
+size_t ug_vertex_buffer_get_capacity(UGVertexBuffer* vb) {
+    return vb ? vb->capacity : 0;
+}
+
+size_t ug_vertex_buffer_get_vertex_size(UGVertexBuffer* vb) {
+    return vb ? vb->vertex_size : 0;
+}
+
+size_t ug_vertex_buffer_get_high_water_mark(UGVertexBuffer* vb) {
+    return vb ? vb->high_water_mark : 0;
+}
+
+void ug_vertex_buffer_reset_high_water_mark(UGVertexBuffer* vb) {
+    if (vb) {
+        vb->high_water_mark = 0;
+    }
+}
+
 WGPUVertexBufferLayout* ug_vertex_buffer_get_layout(UGVertexBuffer* vb) {
     return vb ? &vb->layout : NULL;
 }
 
+bool ug_vertex_buffer_is_streaming(UGVertexBuffer* vb) {
+    return vb ? vb->streaming : false;
+}
+
+bool ug_vertex_buffer_is_shadowed(UGVertexBuffer* vb) {
+    return vb ? vb->shadowed : false;
+}
+
+UGBundleLinks* ug_vertex_buffer_get_bundle_links(UGVertexBuffer* vb) {
+    return vb ? &vb->bundle_links : NULL;
+}
+
 void ug_vertex_buffer_destroy(UGVertexBuffer* vb) {
     if (vb) {
+        ug_bundle_links_release(&vb->bundle_links);
+        if (vb->shadowed) {
+            ug_shadow_copy_release(&vb->shadow);
+        }
         if (vb->buffer) {
             wgpuBufferRelease(vb->buffer);
         }
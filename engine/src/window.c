@@ -1,5 +1,8 @@
 #include "ungrund.h"
+#include "ug_internal.h"
 #include <GLFW/glfw3.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #if defined(__APPLE__)
@@ -19,6 +22,11 @@ struct UGWindow {
     int width;
     int height;
 
+    // Framebuffer size published for threads other than the main one, which
+    // GLFW doesn't allow to query it. Packed as width << 32 | height
+    atomic_bool size_cached;
+    atomic_uint_fast64_t cached_size;
+
     // Input callbacks
     UGKeyCallback key_callback;
     void* key_userdata;
@@ -28,34 +36,87 @@ struct UGWindow {
 
     UGMouseButtonCallback mouse_button_callback;
     void* mouse_button_userdata;
+
+    // Input, resize and expose events delivered so far, for on-demand redraw
+    uint64_t event_count;
+
+    // Key state as delivered to callbacks; answers ug_key_pressed for virtual
+    // windows and during replay
+    bool key_state[GLFW_KEY_LAST + 1];
+    UGInputLog* input_log;   // Recording or replaying log, if any
 };
 
 static bool glfw_initialized = false;
 
-// Internal GLFW callback handlers
+// Deliver input to the user callbacks; live GLFW events and replayed input
+// logs both come through here
+void ug_window_dispatch_key(UGWindow* window, int key, bool pressed) {
+    if (!window) {
+        return;
+    }
+    if (key >= 0 && key <= GLFW_KEY_LAST) {
+        window->key_state[key] = pressed;
+    }
+    ug_input_log_write_key(window->input_log, key, pressed);
+    if (window->key_callback) {
+        window->key_callback(key, pressed, window->key_userdata);
+    }
+}
+
+void ug_window_dispatch_mouse_move(UGWindow* window, double x, double y) {
+    if (!window) {
+        return;
+    }
+    ug_input_log_write_mouse_move(window->input_log, x, y);
+    if (window->mouse_move_callback) {
+        window->mouse_move_callback(x, y, window->mouse_move_userdata);
+    }
+}
+
+void ug_window_dispatch_mouse_button(UGWindow* window, UGMouseButton button, bool pressed) {
+    if (!window) {
+        return;
+    }
+    ug_input_log_write_mouse_button(window->input_log, button, pressed);
+    if (window->mouse_button_callback) {
+        window->mouse_button_callback(button, pressed, window->mouse_button_userdata);
+    }
+}
+
+// Internal GLFW callback handlers. While an input log is replaying, live
+// input is still counted but not delivered
+static UGWindow* live_input_window(GLFWwindow* handle) {
+    UGWindow* window = (UGWindow*)glfwGetWindowUserPointer(handle);
+    if (!window) {
+        return NULL;
+    }
+    window->event_count++;
+    return ug_input_log_is_replaying(window->input_log) ? NULL : window;
+}
+
 static void glfw_key_callback(GLFWwindow* handle, int key, int scancode, int action, int mods) {
     (void)scancode;
     (void)mods;
 
-    UGWindow* window = (UGWindow*)glfwGetWindowUserPointer(handle);
-    if (window && window->key_callback) {
+    UGWindow* window = live_input_window(handle);
+    if (window) {
         bool pressed = (action == GLFW_PRESS || action == GLFW_REPEAT);
-        window->key_callback(key, pressed, window->key_userdata);
+        ug_window_dispatch_key(window, key, pressed);
     }
 }
 
 static void glfw_cursor_pos_callback(GLFWwindow* handle, double xpos, double ypos) {
-    UGWindow* window = (UGWindow*)glfwGetWindowUserPointer(handle);
-    if (window && window->mouse_move_callback) {
-        window->mouse_move_callback(xpos, ypos, window->mouse_move_userdata);
+    UGWindow* window = live_input_window(handle);
+    if (window) {
+        ug_window_dispatch_mouse_move(window, xpos, ypos);
     }
 }
 
 static void glfw_mouse_button_callback(GLFWwindow* handle, int button, int action, int mods) {
     (void)mods;
 
-    UGWindow* window = (UGWindow*)glfwGetWindowUserPointer(handle);
-    if (window && window->mouse_button_callback) {
+    UGWindow* window = live_input_window(handle);
+    if (window) {
         UGMouseButton ug_button;
         switch (button) {
             case GLFW_MOUSE_BUTTON_LEFT:
@@ -72,10 +133,38 @@ static void glfw_mouse_button_callback(GLFWwindow* handle, int button, int actio
         }
 
         bool pressed = (action == GLFW_PRESS);
-        window->mouse_button_callback(ug_button, pressed, window->mouse_button_userdata);
+        ug_window_dispatch_mouse_button(window, ug_button, pressed);
     }
 }
 
+// Events that change what's on screen without going through a user callback
+static void glfw_window_event_callback(GLFWwindow* handle) {
+    UGWindow* window = (UGWindow*)glfwGetWindowUserPointer(handle);
+    if (window) {
+        window->event_count++;
+    }
+}
+
+static void glfw_framebuffer_size_callback(GLFWwindow* handle, int width, int height) {
+    UGWindow* window = (UGWindow*)glfwGetWindowUserPointer(handle);
+    if (window) {
+        window->width = width;
+        window->height = height;
+    }
+    glfw_window_event_callback(handle);
+}
+
+static void glfw_scroll_callback(GLFWwindow* handle, double xoffset, double yoffset) {
+    (void)xoffset;
+    (void)yoffset;
+    glfw_window_event_callback(handle);
+}
+
+static void glfw_focus_callback(GLFWwindow* handle, int focused) {
+    (void)focused;
+    glfw_window_event_callback(handle);
+}
+
 UGWindow* ug_window_create(const char* title, int width, int height) {
     if (!glfw_initialized) {
         if (!glfwInit()) {
@@ -93,41 +182,92 @@ UGWindow* ug_window_create(const char* title, int width, int height) {
         return NULL;
     }
 
-    UGWindow* window = (UGWindow*)malloc(sizeof(UGWindow));
+    // Callbacks, key state and counters start zeroed
+    UGWindow* window = (UGWindow*)calloc(1, sizeof(UGWindow));
+    if (!window) {
+        glfwDestroyWindow(handle);
+        return NULL;
+    }
     window->handle = handle;
     window->width = width;
     window->height = height;
 
-    // Initialize callbacks to NULL
-    window->key_callback = NULL;
-    window->key_userdata = NULL;
-    window->mouse_move_callback = NULL;
-    window->mouse_move_userdata = NULL;
-    window->mouse_button_callback = NULL;
-    window->mouse_button_userdata = NULL;
-
     // Set window user pointer so we can retrieve it in callbacks
     glfwSetWindowUserPointer(handle, window);
 
+    // Input callbacks stay registered so every event is counted; they only
+    // forward to the user callbacks that are set
+    glfwSetKeyCallback(handle, glfw_key_callback);
+    glfwSetCursorPosCallback(handle, glfw_cursor_pos_callback);
+    glfwSetMouseButtonCallback(handle, glfw_mouse_button_callback);
+    glfwSetScrollCallback(handle, glfw_scroll_callback);
+    glfwSetFramebufferSizeCallback(handle, glfw_framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(handle, glfw_window_event_callback);
+    glfwSetWindowFocusCallback(handle, glfw_focus_callback);
+
+    return window;
+}
+
+UGWindow* ug_window_create_virtual(int width, int height) {
+    UGWindow* window = (UGWindow*)calloc(1, sizeof(UGWindow));
+    if (!window) {
+        return NULL;
+    }
+    window->width = width;
+    window->height = height;
     return window;
 }
 
 void ug_window_destroy(UGWindow* window) {
     if (window) {
-        glfwDestroyWindow(window->handle);
+        if (window->handle) {
+            glfwDestroyWindow(window->handle);
+        }
         free(window);
     }
 }
 
 bool ug_window_should_close(UGWindow* window) {
-    return glfwWindowShouldClose(window->handle);
+    return window->handle ? glfwWindowShouldClose(window->handle) : false;
 }
 
 void ug_window_poll_events(UGWindow* window) {
-    glfwPollEvents();
+    if (window->handle) {
+        glfwPollEvents();
+    }
+}
+
+void ug_window_wait_events(UGWindow* window, double timeout_seconds) {
+    if (!window->handle) {
+        return;
+    }
+    if (timeout_seconds < 0.0) {
+        glfwWaitEvents();
+    } else {
+        glfwWaitEventsTimeout(timeout_seconds);
+    }
+}
+
+void ug_window_wake(void) {
+    if (glfw_initialized) {
+        glfwPostEmptyEvent();
+    }
+}
+
+uint64_t ug_window_get_event_count(UGWindow* window) {
+    return window ? window->event_count : 0;
+}
+
+void ug_window_set_input_log(UGWindow* window, UGInputLog* log) {
+    if (window) {
+        window->input_log = log;
+    }
 }
 
 void* ug_window_get_native_handle(UGWindow* window) {
+    if (!window->handle) {
+        return NULL;
+    }
 #if defined(__APPLE__)
     return (void*)glfwGetCocoaWindow(window->handle);
 #elif defined(_WIN32)
@@ -146,14 +286,50 @@ void* ug_window_get_x11_display(void) {
 }
 
 void ug_window_get_size(UGWindow* window, int* width, int* height) {
+    if (!window->handle) {
+        if (width) *width = window->width;
+        if (height) *height = window->height;
+        return;
+    }
+    if (atomic_load(&window->size_cached)) {
+        uint64_t size = atomic_load(&window->cached_size);
+        if (width) *width = (int)(size >> 32);
+        if (height) *height = (int)(size & 0xFFFFFFFF);
+        return;
+    }
+    glfwGetFramebufferSize(window->handle, width, height);
+}
+
+void ug_window_query_size(UGWindow* window, int* width, int* height) {
+    if (!window->handle) {
+        ug_window_get_size(window, width, height);
+        return;
+    }
     glfwGetFramebufferSize(window->handle, width, height);
 }
 
+void ug_window_set_cached_size(UGWindow* window, int width, int height) {
+    if (!window) {
+        return;
+    }
+    atomic_store(&window->cached_size, (uint64_t)(uint32_t)width << 32 | (uint32_t)height);
+    atomic_store(&window->size_cached, true);
+}
+
+void ug_window_clear_cached_size(UGWindow* window) {
+    if (window) {
+        atomic_store(&window->size_cached, false);
+    }
+}
+
 double ug_get_time(void) {
     return glfwGetTime();
 }
 
 bool ug_key_pressed(UGWindow* window, int key) {
+    if (!window->handle || ug_input_log_is_replaying(window->input_log)) {
+        return key >= 0 && key <= GLFW_KEY_LAST && window->key_state[key];
+    }
     return glfwGetKey(window->handle, key) == GLFW_PRESS;
 }
 
@@ -165,13 +341,6 @@ void ug_window_set_key_callback(UGWindow* window, UGKeyCallback callback, void*
 
     window->key_callback = callback;
     window->key_userdata = userdata;
-
-    // Register GLFW callback if user callback is set, otherwise unregister
-    if (callback) {
-        glfwSetKeyCallback(window->handle, glfw_key_callback);
-    } else {
-        glfwSetKeyCallback(window->handle, NULL);
-    }
 }
 
 void ug_window_set_mouse_move_callback(UGWindow* window, UGMouseMoveCallback callback, void* userdata) {
@@ -181,13 +350,6 @@ void ug_window_set_mouse_move_callback(UGWindow* window, UGMouseMoveCallback cal
 
     window->mouse_move_callback = callback;
     window->mouse_move_userdata = userdata;
-
-    // Register GLFW callback if user callback is set, otherwise unregister
-    if (callback) {
-        glfwSetCursorPosCallback(window->handle, glfw_cursor_pos_callback);
-    } else {
-        glfwSetCursorPosCallback(window->handle, NULL);
-    }
 }
 
 void ug_window_set_mouse_button_callback(UGWindow* window, UGMouseButtonCallback callback, void* userdata) {
@@ -197,22 +359,6 @@ void ug_window_set_mouse_button_callback(UGWindow* window, UGMouseButtonCallback
 
     window->mouse_button_callback = callback;
     window->mouse_button_userdata = userdata;
-
-    // Register GLFW callback if user callback is set, otherwise unregister
-    if (callback) {
-        glfwSetMouseButtonCallback(window->handle, glfw_mouse_button_callback);
-    } else {
-        glfwSetMouseButtonCallback(window->handle, NULL);
-    }
-}
-
-// Get X11 display (Linux only)
-void* ug_window_get_x11_display(void) {
-#if defined(__linux__)
-    return glfwGetX11Display();
-#else
-    return NULL;
-#endif
 }
 
 // Get GLFW window handle (for internal use)
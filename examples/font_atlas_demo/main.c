@@ -94,7 +94,8 @@ void render(UGContext* context, UGRenderFrame* frame, float delta_time, void* us
     // Render
     UGRenderPass* pass = ug_render_pass_begin(frame, 0.1f, 0.1f, 0.15f, 1.0f);
 
-    ug_render_pass_set_pipeline(pass, ug_font_atlas_get_pipeline(state->font));
+    ug_render_pass_set_pipeline_topology(pass, ug_font_atlas_get_pipeline(state->font),
+                                         WGPUPrimitiveTopology_TriangleList);
     ug_render_pass_set_bind_group(pass, 0, ug_font_atlas_get_bind_group(state->font));
     ug_render_pass_set_vertex_buffer(pass, state->vertex_buffer);
     ug_render_pass_draw(pass, state->vertex_count);
@@ -70,7 +70,7 @@ void render(UGContext* context, UGRenderFrame* frame, float delta_time, void* us
 
     // Render
     UGRenderPass* pass = ug_render_pass_begin(frame, 0.1f, 0.1f, 0.15f, 1.0f);
-    ug_render_pass_set_pipeline(pass, data->pipeline);
+    ug_render_pass_set_pipeline_topology(pass, data->pipeline, WGPUPrimitiveTopology_TriangleList);
     ug_render_pass_set_vertex_buffer(pass, data->vertex_buffer);
     ug_render_pass_draw(pass, data->vertex_count);
     ug_render_pass_end(pass);
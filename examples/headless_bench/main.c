@@ -0,0 +1,278 @@
+#include "ungrund.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Headless benchmark - renders the sprite, text or geometry path into an
+// offscreen texture with no window, and reports frame throughput.
+// Usage: headless_bench [sprite|text|geometry] [frames] [font.ttf]
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define DEFAULT_FRAMES 1000
+#define MAX_VERTICES 60000
+
+typedef enum {
+    BENCH_SPRITE,
+    BENCH_TEXT,
+    BENCH_GEOMETRY,
+} BenchMode;
+
+typedef struct {
+    BenchMode mode;
+    float time;
+
+    UGVertexBuffer* vertex_buffer;
+    WGPURenderPipeline pipeline;
+    WGPUBindGroup bind_group;
+    void* vertices;
+
+    // Sprite path
+    UGSpriteSheet* sprite_sheet;
+
+    // Text path
+    UGFontAtlas* font;
+
+    // GPU time accumulated from each newly resolved profiler result
+    double gpu_ms_total;
+    uint64_t gpu_frames;
+    uint64_t last_gpu_frame;
+} BenchState;
+
+static void render_sprites(BenchState* state, size_t* count) {
+    UGVertex2DTextured* vertices = (UGVertex2DTextured*)state->vertices;
+    int sprite_count = ug_sprite_sheet_get_sprite_count(state->sprite_sheet);
+
+    // A 100x100 grid of animated sprites
+    for (int i = 0; i < 10000; i++) {
+        float x = -0.99f + (i % 100) * 0.02f;
+        float y = -0.99f + (i / 100) * 0.02f + 0.005f * sinf(state->time * 4.0f + i);
+        int sprite = (i + (int)(state->time * 10.0f)) % sprite_count;
+        ug_sprite_sheet_add_sprite_indexed(state->sprite_sheet, vertices, count, sprite, x, y, 0.01f, 0.01f);
+    }
+}
+
+static void render_text(BenchState* state, UGContext* context, size_t* count) {
+    char line[64];
+    for (int i = 0; i < 40; i++) {
+        snprintf(line, sizeof(line), "Line %02d: the quick brown fox %.3f", i, state->time);
+        ug_font_atlas_add_text_px_indexed(state->font, state->vertices, count, line,
+                                          10.0f, 18.0f + i * 17.5f, context, 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+}
+
+static void render_geometry(BenchState* state, size_t* count) {
+    UGVertex2DColor* vertices = (UGVertex2DColor*)state->vertices;
+
+    // 400 circles of 32 segments plus as many rectangles
+    for (int i = 0; i < 400; i++) {
+        float x = -0.95f + (i % 20) * 0.1f;
+        float y = -0.95f + (i / 20) * 0.1f;
+        float pulse = 0.02f + 0.01f * sinf(state->time * 3.0f + i);
+        ug_add_circle_2d_color(vertices, count, x, y, pulse, 0.0f, 0.2f, 0.7f, 1.0f, 32);
+        ug_add_rect_2d_color(vertices, count, x, y, 0.01f, 0.01f, 1.0f, 0.4f, 0.1f);
+    }
+}
+
+static void collect_gpu_time(BenchState* state, UGContext* context) {
+    double pass_ms[1];
+    if (ug_profiler_get_pass_times(context, pass_ms, 1) == 0) {
+        return;
+    }
+
+    uint64_t result_frame = ug_profiler_get_result_frame(context);
+    if (state->gpu_frames == 0 || result_frame != state->last_gpu_frame) {
+        state->gpu_ms_total += ug_profiler_get_frame_gpu_time(context);
+        state->gpu_frames++;
+        state->last_gpu_frame = result_frame;
+    }
+}
+
+static void render(UGContext* context, UGRenderFrame* frame, float delta_time, void* userdata) {
+    BenchState* state = (BenchState*)userdata;
+    state->time += delta_time;
+    collect_gpu_time(state, context);
+
+    size_t vertex_count = 0;
+    switch (state->mode) {
+        case BENCH_SPRITE:
+            render_sprites(state, &vertex_count);
+            break;
+        case BENCH_TEXT:
+            render_text(state, context, &vertex_count);
+            break;
+        case BENCH_GEOMETRY:
+            render_geometry(state, &vertex_count);
+            break;
+    }
+
+    ug_vertex_buffer_update(state->vertex_buffer, state->vertices, vertex_count);
+
+    UGRenderPass* pass = ug_render_pass_begin(frame, 0.1f, 0.1f, 0.15f, 1.0f);
+    ug_render_pass_set_pipeline_topology(pass, state->pipeline, WGPUPrimitiveTopology_TriangleList);
+    if (state->bind_group) {
+        ug_render_pass_set_bind_group(pass, 0, state->bind_group);
+    }
+    ug_render_pass_set_vertex_buffer(pass, state->vertex_buffer);
+    if (state->mode == BENCH_GEOMETRY) {
+        ug_render_pass_draw(pass, (uint32_t)vertex_count);
+    } else {
+        // Sprites and glyphs are written as 4-vertex quads
+        ug_render_pass_draw_quads(pass, 0, (uint32_t)(vertex_count / 4));
+    }
+    ug_render_pass_end(pass);
+}
+
+int main(int argc, char** argv) {
+    BenchState state = {0};
+    state.mode = BENCH_SPRITE;
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "text") == 0) {
+            state.mode = BENCH_TEXT;
+        } else if (strcmp(argv[1], "geometry") == 0) {
+            state.mode = BENCH_GEOMETRY;
+        } else if (strcmp(argv[1], "sprite") != 0) {
+            fprintf(stderr, "Unknown benchmark '%s' (expected sprite, text or geometry)\n", argv[1]);
+            return 1;
+        }
+    }
+    uint64_t frames = argc > 2 ? strtoull(argv[2], NULL, 10) : DEFAULT_FRAMES;
+    const char* font_path = argc > 3 ? argv[3] : "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+
+    // Create a headless context - no window or display required
+    UGContextBuilder* builder = ug_context_builder_create(NULL);
+    ug_context_builder_set_headless(builder, BENCH_WIDTH, BENCH_HEIGHT);
+    ug_context_builder_set_frame_limit(builder, frames);
+    ug_context_builder_enable_gpu_profiler(builder, true);
+    UGContext* context = ug_context_builder_build(builder);
+    ug_context_builder_destroy(builder);
+    if (!context) {
+        fprintf(stderr, "Failed to create headless context\n");
+        return 1;
+    }
+
+    UGTexture* texture = NULL;
+    UGBindGroupBuilder* bg_builder = NULL;
+    WGPUBindGroupLayout bind_group_layout = NULL;
+    WGPUPipelineLayout pipeline_layout = NULL;
+    UGPipelineBuilder* pipeline_builder = NULL;
+
+    switch (state.mode) {
+        case BENCH_SPRITE: {
+            texture = ug_texture_create_from_file(context, "examples/sprite_demo/spritesheet.png");
+            if (!texture) {
+                ug_context_destroy(context);
+                return 1;
+            }
+            state.sprite_sheet = ug_sprite_sheet_create(texture, 32, 32);
+            state.vertex_buffer = ug_vertex_buffer_create_2d_textured(context, MAX_VERTICES);
+
+            bg_builder = ug_bind_group_builder_create(context);
+            ug_bind_group_builder_add_texture(bg_builder, 0, ug_texture_get_view(texture),
+                                              ug_texture_get_sampler(texture));
+            bind_group_layout = ug_bind_group_builder_create_layout(bg_builder);
+            state.bind_group = ug_bind_group_builder_build(bg_builder, bind_group_layout);
+
+            WGPUPipelineLayoutDescriptor pipeline_layout_desc = {
+                .bindGroupLayoutCount = 1,
+                .bindGroupLayouts = &bind_group_layout,
+            };
+            pipeline_layout = wgpuDeviceCreatePipelineLayout(ug_context_get_device(context),
+                                                             &pipeline_layout_desc);
+
+            pipeline_builder = ug_pipeline_builder_create(context, "examples/sprite_demo/sprite.wgsl");
+            if (!pipeline_builder) {
+                ug_context_destroy(context);
+                return 1;
+            }
+            ug_pipeline_builder_set_vertex_buffer(pipeline_builder, ug_vertex_buffer_get_layout(state.vertex_buffer));
+            ug_pipeline_builder_set_layout(pipeline_builder, pipeline_layout);
+            ug_pipeline_builder_enable_blending(pipeline_builder, true);
+            state.pipeline = ug_pipeline_builder_build(pipeline_builder);
+            break;
+        }
+        case BENCH_TEXT: {
+            state.font = ug_font_atlas_create(context, font_path, 16, 512, 512);
+            if (!state.font) {
+                fprintf(stderr, "Failed to create font atlas from %s\n", font_path);
+                ug_context_destroy(context);
+                return 1;
+            }
+            state.vertex_buffer = ug_vertex_buffer_create(context, ug_font_atlas_get_vertex_size(), MAX_VERTICES);
+            UGVertexAttribute attributes[3];
+            ug_font_atlas_get_vertex_attributes(attributes);
+            ug_vertex_buffer_set_layout(state.vertex_buffer, attributes, 3);
+
+            // The font atlas owns its pipeline and bind group
+            state.pipeline = ug_font_atlas_get_pipeline(state.font);
+            wgpuRenderPipelineAddRef(state.pipeline);
+            state.bind_group = ug_font_atlas_get_bind_group(state.font);
+            break;
+        }
+        case BENCH_GEOMETRY: {
+            state.vertex_buffer = ug_vertex_buffer_create_2d_color(context, MAX_VERTICES);
+            pipeline_builder = ug_pipeline_builder_create(context, "examples/geometry_demo/shader.wgsl");
+            if (!pipeline_builder) {
+                ug_context_destroy(context);
+                return 1;
+            }
+            ug_pipeline_builder_set_vertex_buffer(pipeline_builder, ug_vertex_buffer_get_layout(state.vertex_buffer));
+            state.pipeline = ug_pipeline_builder_build(pipeline_builder);
+            break;
+        }
+    }
+
+    state.vertices = malloc(ug_font_atlas_get_vertex_size() * MAX_VERTICES);
+
+    static const char* mode_names[] = {"sprite", "text", "geometry"};
+    printf("Running %s benchmark: %llu frames at %dx%d (headless)\n",
+           mode_names[state.mode], (unsigned long long)frames, BENCH_WIDTH, BENCH_HEIGHT);
+
+    uint64_t start = ug_get_time_ns();
+    ug_run(context, render, &state);
+    double seconds = (double)(ug_get_time_ns() - start) * 1e-9;
+
+    printf("Rendered %llu frames in %.3f s: %.1f frames/s, %.3f ms/frame\n",
+           (unsigned long long)frames, seconds, frames / seconds, seconds * 1000.0 / frames);
+    if (state.gpu_frames > 0) {
+        printf("GPU time: %.3f ms/frame over %llu profiled frames\n",
+               state.gpu_ms_total / state.gpu_frames, (unsigned long long)state.gpu_frames);
+    }
+
+    UGFrameStats stats;
+    if (ug_context_get_frame_stats(context, &stats)) {
+        printf("Frame time (last %u): p50 %.3f  p95 %.3f  p99 %.3f  max %.3f ms\n",
+               stats.frame_time.sample_count, stats.frame_time.p50_ms, stats.frame_time.p95_ms,
+               stats.frame_time.p99_ms, stats.frame_time.max_ms);
+        printf("CPU record:         p50 %.3f  p95 %.3f  p99 %.3f  max %.3f ms\n",
+               stats.cpu_time.p50_ms, stats.cpu_time.p95_ms, stats.cpu_time.p99_ms, stats.cpu_time.max_ms);
+        printf("Per frame: %u draws, %u pipeline / %u bind group switches, %llu bytes uploaded\n",
+               stats.last_frame.draw_calls, stats.last_frame.pipeline_switches,
+               stats.last_frame.bind_group_switches, (unsigned long long)stats.last_frame.upload_bytes);
+        printf("Render pass: %u redundant state calls dropped, %u draws merged\n",
+               stats.last_frame.redundant_state_calls, stats.last_frame.merged_draws);
+    }
+
+    // Only produces a file in PROFILE=1 builds
+    if (ug_profile_write_chrome_trace("headless_bench_trace.json")) {
+        printf("Wrote CPU trace to headless_bench_trace.json\n");
+    }
+
+    // Cleanup
+    free(state.vertices);
+    if (state.pipeline) wgpuRenderPipelineRelease(state.pipeline);
+    if (state.mode != BENCH_TEXT && state.bind_group) wgpuBindGroupRelease(state.bind_group);
+    if (bind_group_layout) wgpuBindGroupLayoutRelease(bind_group_layout);
+    if (pipeline_layout) wgpuPipelineLayoutRelease(pipeline_layout);
+    ug_bind_group_builder_destroy(bg_builder);
+    ug_pipeline_builder_destroy(pipeline_builder);
+    ug_sprite_sheet_destroy(state.sprite_sheet);
+    ug_texture_destroy(texture);
+    ug_font_atlas_destroy(state.font);
+    ug_vertex_buffer_destroy(state.vertex_buffer);
+    ug_context_destroy(context);
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "ungrund.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 // Vertex structure
@@ -16,6 +17,7 @@ typedef struct {
 #define PADDLE_SPEED 1.0f
 #define BALL_SPEED 0.8f
 #define MAX_VERTICES 1024
+#define SIMULATION_RATE 120.0
 
 // Game state
 typedef struct {
@@ -29,6 +31,12 @@ typedef struct {
     float ball_vx;
     float ball_vy;
 
+    // State before the latest simulation step, for render interpolation
+    float prev_left_paddle_y;
+    float prev_right_paddle_y;
+    float prev_ball_x;
+    float prev_ball_y;
+
     // Scores
     int left_score;
     int right_score;
@@ -55,6 +63,10 @@ void init_game(GameState* game) {
     game->ball_vy = BALL_SPEED * 0.5f;
     game->left_score = 0;
     game->right_score = 0;
+    game->prev_left_paddle_y = 0.0f;
+    game->prev_right_paddle_y = 0.0f;
+    game->prev_ball_x = 0.0f;
+    game->prev_ball_y = 0.0f;
 
     // Initialize input state
     game->key_w_pressed = false;
@@ -70,6 +82,14 @@ void reset_ball(GameState* game) {
     // Randomize direction slightly
     game->ball_vx = (game->ball_vx > 0 ? -BALL_SPEED : BALL_SPEED);
     game->ball_vy = BALL_SPEED * ((float)rand() / RAND_MAX - 0.5f);
+
+    // Teleport - don't interpolate across the reset
+    game->prev_ball_x = game->ball_x;
+    game->prev_ball_y = game->ball_y;
+}
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
 }
 
 // Add a rectangle to the vertex buffer
@@ -178,8 +198,16 @@ void on_key_event(int key, bool pressed, void* userdata) {
     }
 }
 
-// Update game logic
-void update_game(GameState* game, float dt) {
+// Update game logic - called at the fixed simulation rate
+void update_game(UGContext* context, float dt, void* userdata) {
+    GameState* game = (GameState*)userdata;
+    (void)context;
+
+    game->prev_left_paddle_y = game->left_paddle_y;
+    game->prev_right_paddle_y = game->right_paddle_y;
+    game->prev_ball_x = game->ball_x;
+    game->prev_ball_y = game->ball_y;
+
     // Handle input for left paddle (W/S) - now using callback state
     if (game->key_w_pressed) {
         game->left_paddle_y += PADDLE_SPEED * dt;
@@ -247,56 +275,80 @@ void update_game(GameState* game, float dt) {
     }
 }
 
-// Render callback
-void render(UGContext* context, UGRenderFrame* frame, float delta_time, void* userdata) {
+// Render callback - draws the state interpolated between the last two updates
+void render(UGContext* context, UGRenderFrame* frame, float alpha, void* userdata) {
     GameState* game = (GameState*)userdata;
     (void)context;
 
-    // Update game logic
-    update_game(game, delta_time);
+    float left_paddle_y = lerp(game->prev_left_paddle_y, game->left_paddle_y, alpha);
+    float right_paddle_y = lerp(game->prev_right_paddle_y, game->right_paddle_y, alpha);
+    float ball_x = lerp(game->prev_ball_x, game->ball_x, alpha);
+    float ball_y = lerp(game->prev_ball_y, game->ball_y, alpha);
 
-    // Build vertex data
-    Vertex vertices[MAX_VERTICES];
+    // Build vertex data in per-frame scratch memory (freed when the frame ends).
+    // If the allocation fails, the buffer keeps last frame's geometry
+    Vertex* vertices = UG_FRAME_ALLOC_ARRAY(frame, Vertex, MAX_VERTICES);
     size_t vertex_count = 0;
-
-    // Draw center line (dashed)
-    for (int i = 0; i < 20; i++) {
-        float y = -1.0f + (i * 0.1f);
-        add_rect(vertices, &vertex_count, 0.0f, y, 0.005f, 0.04f, 0.5f, 0.5f, 0.5f);
+    if (vertices) {
+        // Draw center line (dashed)
+        for (int i = 0; i < 20; i++) {
+            float y = -1.0f + (i * 0.1f);
+            add_rect(vertices, &vertex_count, 0.0f, y, 0.005f, 0.04f, 0.5f, 0.5f, 0.5f);
+        }
+
+        // Draw scores at the top
+        draw_number(vertices, &vertex_count, game->left_score, -0.3f, 0.75f, 0.15f, 0.8f, 0.8f, 0.8f);
+        draw_number(vertices, &vertex_count, game->right_score, 0.3f, 0.75f, 0.15f, 0.8f, 0.8f, 0.8f);
+
+        // Draw paddles
+        add_rect(vertices, &vertex_count, -0.95f, left_paddle_y, PADDLE_WIDTH, PADDLE_HEIGHT, 1.0f, 1.0f, 1.0f);
+        add_rect(vertices, &vertex_count, 0.95f, right_paddle_y, PADDLE_WIDTH, PADDLE_HEIGHT, 1.0f, 1.0f, 1.0f);
+
+        // Draw ball
+        add_rect(vertices, &vertex_count, ball_x, ball_y, BALL_SIZE, BALL_SIZE, 1.0f, 1.0f, 0.0f);
+
+        // Update vertex buffer (only the changed vertices are uploaded)
+        ug_vertex_buffer_update(game->vertex_buffer, vertices, vertex_count);
+        game->vertex_count = vertex_count;
     }
 
-    // Draw scores at the top
-    draw_number(vertices, &vertex_count, game->left_score, -0.3f, 0.75f, 0.15f, 0.8f, 0.8f, 0.8f);
-    draw_number(vertices, &vertex_count, game->right_score, 0.3f, 0.75f, 0.15f, 0.8f, 0.8f, 0.8f);
-
-    // Draw paddles
-    add_rect(vertices, &vertex_count, -0.95f, game->left_paddle_y, PADDLE_WIDTH, PADDLE_HEIGHT, 1.0f, 1.0f, 1.0f);
-    add_rect(vertices, &vertex_count, 0.95f, game->right_paddle_y, PADDLE_WIDTH, PADDLE_HEIGHT, 1.0f, 1.0f, 1.0f);
-
-    // Draw ball
-    add_rect(vertices, &vertex_count, game->ball_x, game->ball_y, BALL_SIZE, BALL_SIZE, 1.0f, 1.0f, 0.0f);
-
-    // Update vertex buffer (simplified!)
-    ug_vertex_buffer_update(game->vertex_buffer, vertices, vertex_count);
-    game->vertex_count = vertex_count;
-
     // Render (simplified - no WebGPU boilerplate!)
     UGRenderPass* pass = ug_render_pass_begin(frame, 0.0f, 0.0f, 0.0f, 1.0f);
-    ug_render_pass_set_pipeline(pass, game->pipeline);
+    ug_render_pass_set_pipeline_topology(pass, game->pipeline, WGPUPrimitiveTopology_TriangleList);
     ug_render_pass_set_vertex_buffer(pass, game->vertex_buffer);
     ug_render_pass_draw(pass, game->vertex_count);
     ug_render_pass_end(pass);
 }
 
-int main(void) {
+// Usage: pong [--record session.bin | --replay session.bin]
+// A replay runs headless at full speed and prints frame statistics
+int main(int argc, char** argv) {
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            replay_path = argv[++i];
+        }
+    }
+
     // Create window and context
-    UGWindow* window = ug_window_create("Pong", 800, 600);
+    UGWindow* window = replay_path ? ug_window_create_virtual(800, 600) : ug_window_create("Pong", 800, 600);
     if (!window) {
         fprintf(stderr, "Failed to create window\n");
         return 1;
     }
 
-    UGContext* context = ug_context_create(window);
+    UGContextBuilder* builder = ug_context_builder_create(window);
+    if (replay_path) {
+        ug_context_builder_set_headless(builder, 800, 600);
+        ug_context_builder_replay_input(builder, replay_path);
+    } else if (record_path) {
+        ug_context_builder_record_input(builder, record_path);
+    }
+    UGContext* context = ug_context_builder_build(builder);
+    ug_context_builder_destroy(builder);
     if (!context) {
         fprintf(stderr, "Failed to create context\n");
         ug_window_destroy(window);
@@ -306,6 +358,8 @@ int main(void) {
     // Create vertex buffer with automatic layout setup!
     // Note: Vertex structure matches UGVertex2DColor (position + color)
     UGVertexBuffer* vertex_buffer = ug_vertex_buffer_create_2d_color(context, MAX_VERTICES);
+    // Most of the scene is static from frame to frame; only upload what moved
+    ug_vertex_buffer_enable_shadow(vertex_buffer);
 
     // Build pipeline (simplified!)
     UGPipelineBuilder* pipeline_builder = ug_pipeline_builder_create(context, "examples/pong/pong.wgsl");
@@ -331,8 +385,20 @@ int main(void) {
     // Set up input callback
     ug_window_set_key_callback(window, on_key_event, &game_state);
 
-    // Run
-    ug_run(context, render, &game_state);
+    // Run - physics steps at a fixed rate independent of the display
+    UGFixedStepConfig step_config = {
+        .step_seconds = 1.0 / SIMULATION_RATE,
+    };
+    ug_run_fixed(context, &step_config, update_game, render, &game_state);
+
+    if (replay_path) {
+        UGFrameStats stats;
+        ug_context_get_frame_stats(context, &stats);
+        printf("Replayed %llu frames, final score %d - %d\n", (unsigned long long)stats.frames,
+               game_state.left_score, game_state.right_score);
+        printf("CPU time p50 %.3f ms, p95 %.3f ms, p99 %.3f ms\n",
+               stats.cpu_time.p50_ms, stats.cpu_time.p95_ms, stats.cpu_time.p99_ms);
+    }
 
     // Cleanup (simplified!)
     ug_vertex_buffer_destroy(vertex_buffer);
@@ -42,36 +42,38 @@ void render(UGContext* context, UGRenderFrame* frame, float delta_time, void* us
     data->sprite2_x = -0.5f * cosf(time * 1.5f);
     data->sprite3_rotation = time;
     
-    // Build vertex data
-    UGVertex2DTextured vertices[MAX_VERTICES];
+    // Build vertex data in per-frame scratch memory (freed when the frame ends).
+    // If the allocation fails, the frame is drawn without sprites
+    UGVertex2DTextured* vertices = UG_FRAME_ALLOC_ARRAY(frame, UGVertex2DTextured, MAX_VERTICES);
     size_t vertex_count = 0;
+    if (vertices) {
+        // Sprite 1: Animated sprite moving horizontally
+        ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
+                                  data->current_frame, data->sprite1_x, 0.5f, 0.15f, 0.15f);
     
-    // Sprite 1: Animated sprite moving horizontally
-    ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
-                              data->current_frame, data->sprite1_x, 0.5f, 0.15f, 0.15f);
+        // Sprite 2: Same animation, different position
+        ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
+                                  data->current_frame, data->sprite2_x, -0.5f, 0.15f, 0.15f);
     
-    // Sprite 2: Same animation, different position
-    ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
-                              data->current_frame, data->sprite2_x, -0.5f, 0.15f, 0.15f);
+        // Sprite 3: Different frame (static)
+        int static_frame = (data->frame_count / 2) % data->frame_count;
+        ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
+                                  static_frame, 0.0f, 0.0f, 0.2f, 0.2f);
     
-    // Sprite 3: Different frame (static)
-    int static_frame = (data->frame_count / 2) % data->frame_count;
-    ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
-                              static_frame, 0.0f, 0.0f, 0.2f, 0.2f);
+        // Sprite 4: Show all frames in a row (for demonstration)
+        for (int i = 0; i < data->frame_count && i < 8; i++) {
+            float x = -0.8f + (i * 0.25f);
+            ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
+                                      i, x, -0.8f, 0.08f, 0.08f);
+        }
     
-    // Sprite 4: Show all frames in a row (for demonstration)
-    for (int i = 0; i < data->frame_count && i < 8; i++) {
-        float x = -0.8f + (i * 0.25f);
-        ug_sprite_sheet_add_sprite(data->sprite_sheet, vertices, &vertex_count,
-                                  i, x, -0.8f, 0.08f, 0.08f);
+        // Update vertex buffer
+        ug_vertex_buffer_update(data->vertex_buffer, vertices, vertex_count);
     }
     
-    // Update vertex buffer
-    ug_vertex_buffer_update(data->vertex_buffer, vertices, vertex_count);
-    
     // Render
     UGRenderPass* pass = ug_render_pass_begin(frame, 0.1f, 0.1f, 0.15f, 1.0f);
-    ug_render_pass_set_pipeline(pass, data->pipeline);
+    ug_render_pass_set_pipeline_topology(pass, data->pipeline, WGPUPrimitiveTopology_TriangleList);
     ug_render_pass_set_bind_group(pass, 0, data->bind_group);
     ug_render_pass_set_vertex_buffer(pass, data->vertex_buffer);
     ug_render_pass_draw(pass, vertex_count);
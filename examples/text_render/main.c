@@ -95,25 +95,28 @@ void render(UGContext* context, UGRenderFrame* frame, float delta_time, void* us
     ug_uniform_buffer_update(data->uniform, &data->uniforms, sizeof(RenderUniforms));
 
     // Build dynamic vertex buffer with multiple quads (batch rendering demonstration)
-    Vertex vertices[MAX_VERTICES];
+    // Vertices live in per-frame scratch memory, released when the frame ends
+    // The allocation can fail; the buffer then keeps last frame's quads
+    Vertex* vertices = UG_FRAME_ALLOC_ARRAY(frame, Vertex, MAX_VERTICES);
     size_t vertex_count = 0;
-
-    // Main text quad (original position)
-    add_quad_to_batch(vertices, &vertex_count, -0.8f, 0.5f, 1.6f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-    // Add smaller duplicate quads to demonstrate batching
-    float scale = 0.3f;
-    add_quad_to_batch(vertices, &vertex_count,
-                      -0.9f, -0.8f, 1.6f * scale, -1.0f * scale,
-                      0.0f, 0.0f, 1.0f, 1.0f);
-
-    add_quad_to_batch(vertices, &vertex_count,
-                      0.3f, -0.8f, 1.6f * scale, -1.0f * scale,
-                      0.0f, 0.0f, 1.0f, 1.0f);
-
-    // Update dynamic vertex buffer
-    wgpuQueueWriteBuffer(data->queue, data->vertex_buffer, 0, vertices, vertex_count * sizeof(Vertex));
-    data->vertex_count = vertex_count;
+    if (vertices) {
+        // Main text quad (original position)
+        add_quad_to_batch(vertices, &vertex_count, -0.8f, 0.5f, 1.6f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+
+        // Add smaller duplicate quads to demonstrate batching
+        float scale = 0.3f;
+        add_quad_to_batch(vertices, &vertex_count,
+                          -0.9f, -0.8f, 1.6f * scale, -1.0f * scale,
+                          0.0f, 0.0f, 1.0f, 1.0f);
+
+        add_quad_to_batch(vertices, &vertex_count,
+                          0.3f, -0.8f, 1.6f * scale, -1.0f * scale,
+                          0.0f, 0.0f, 1.0f, 1.0f);
+
+        // Update dynamic vertex buffer
+        wgpuQueueWriteBuffer(data->queue, data->vertex_buffer, 0, vertices, vertex_count * sizeof(Vertex));
+        data->vertex_count = vertex_count;
+    }
 
     // Setup render pass
     WGPURenderPassColorAttachment color_attachment = {